@@ -0,0 +1,194 @@
+/*
+  ==============================================================================
+
+    BenchmarkHelpers.h
+    Timing, reporting and setup shared by the SimpleEQ benchmarks.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+namespace Benchmark
+{
+    //minimum wall clock per measurement, set from the command line
+    inline double minSecondsPerMeasurement = 0.25;
+
+    //rdtsc on x86 (counts at the nominal clock), elsewhere cycles are estimated from the reported CPU speed
+    inline constexpr bool hasCycleCounter = JUCE_INTEL != 0;
+
+    inline juce::uint64 readCycleCounter()
+    {
+       #if JUCE_INTEL
+        return (juce::uint64) __rdtsc();
+       #else
+        return 0;
+       #endif
+    }
+
+    struct Measurement
+    {
+        double nsPerSample = 0.0;
+        double cyclesPerSample = 0.0;
+    };
+
+    /**
+     calls 'process' (one block of numSamples) until at least minSecondsPerMeasurement of wall clock has gone by.
+     */
+    template<typename ProcessFn>
+    Measurement measure(ProcessFn&& process, size_t numSamples)
+    {
+        for( int i = 0; i < 16; ++i )
+            process();
+
+        juce::int64 numBlocks = 0;
+        auto startCycles = readCycleCounter();
+        auto start = juce::Time::getHighResolutionTicks();
+        auto elapsed = 0.0;
+
+        do
+        {
+            for( int i = 0; i < 32; ++i )
+                process();
+
+            numBlocks += 32;
+            elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        }
+        while( elapsed < minSecondsPerMeasurement );
+
+        auto cycles = readCycleCounter() - startCycles;
+        auto totalSamples = double(numBlocks) * double(numSamples);
+
+        Measurement m;
+        m.nsPerSample = elapsed * 1.0e9 / totalSamples;
+        m.cyclesPerSample = hasCycleCounter ? double(cycles) / totalSamples
+                                            : m.nsPerSample * juce::SystemStats::getCpuSpeedInMegahertz() / 1000.0;
+        return m;
+    }
+
+    /**
+     collects every measurement so a run can be written out as JSON and diffed against another commit.
+     */
+    class Report
+    {
+    public:
+        void add(const juce::String& benchmark, const juce::NamedValueSet& parameters, const Measurement& m)
+        {
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("benchmark", benchmark);
+
+            for( const auto& parameter : parameters )
+                entry->setProperty(parameter.name, parameter.value);
+
+            entry->setProperty("nsPerSample", m.nsPerSample);
+            entry->setProperty("cyclesPerSample", m.cyclesPerSample);
+            results.add(juce::var(entry));
+        }
+
+        juce::String toJSON() const
+        {
+            auto* root = new juce::DynamicObject();
+            root->setProperty("cpu", juce::SystemStats::getCpuModel());
+            root->setProperty("cpuMHz", juce::SystemStats::getCpuSpeedInMegahertz());
+            root->setProperty("os", juce::SystemStats::getOperatingSystemName());
+            root->setProperty("cycleSource", hasCycleCounter ? "tsc" : "cpu-speed-estimate");
+            root->setProperty("minSecondsPerMeasurement", minSecondsPerMeasurement);
+            root->setProperty("results", results);
+
+            return juce::JSON::toString(juce::var(root));
+        }
+
+    private:
+        juce::Array<juce::var> results;
+    };
+
+    //==============================================================================
+    //same seed every time, so a float and a double buffer of the same size hold the same noise
+    template<typename SampleType>
+    void fillWithNoise(juce::AudioBuffer<SampleType>& buffer)
+    {
+        juce::Random random(0x5eed);
+        for( int ch = 0; ch < buffer.getNumChannels(); ++ch )
+            for( int i = 0; i < buffer.getNumSamples(); ++i )
+                buffer.setSample(ch, i, SampleType(random.nextFloat() * 2.f - 1.f));
+    }
+
+    inline int slopeInDecibelsPerOctave(int slope) { return 6 * getCutOrder(slope); }
+
+    //low cut + peak + high cut with the given slopes, 96/96 is the heaviest configuration of the EQ
+    inline ChainSettings makeSettings(int lowCutSlope = Slope::Slope_96, int highCutSlope = Slope::Slope_96)
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = 80.f;
+        settings.highCutFreq = 9000.f;
+        settings.lowCutSlope = lowCutSlope;
+        settings.highCutSlope = highCutSlope;
+        settings.peakFreq = 750.f;
+        settings.peakGainInDecibels = 6.f;
+        settings.peakQuality = 1.f;
+        return settings;
+    }
+
+    //pushes 'settings' through the processor's parameters, the same way a host would
+    inline void applySettings(SimpleEQAudioProcessor& processor, const ChainSettings& settings)
+    {
+        auto set = [&processor](const juce::String& id, float value)
+        {
+            auto* param = processor.apvts.getParameter(id);
+            param->setValueNotifyingHost(param->convertTo0to1(value));
+        };
+
+        set("LowCut Freq", settings.lowCutFreq);
+        set("HighCut Freq", settings.highCutFreq);
+        set("Peak Freq", settings.peakFreq);
+        set("Peak Gain", settings.peakGainInDecibels);
+        set("Peak Quality", settings.peakQuality);
+        set("LowCut Slope v2", (float) settings.lowCutSlope);
+        set("HighCut Slope v2", (float) settings.highCutSlope);
+    }
+
+    struct DesignedCoefficients
+    {
+        CutCoefficients<float> lowCut, highCut;
+        BiquadCoefficients<float> peak;
+    };
+
+    inline DesignedCoefficients designAll(const ChainSettings& settings, double sampleRate)
+    {
+        DesignedCoefficients designed;
+        designLowCutFilter(designed.lowCut, settings, sampleRate);
+        designPeakFilter(designed.peak, settings, sampleRate);
+        designHighCutFilter(designed.highCut, settings, sampleRate);
+        return designed;
+    }
+
+    inline void prepareMonoChain(MonoChain& chain, const ChainSettings& settings, const DesignedCoefficients& designed, const juce::dsp::ProcessSpec& spec)
+    {
+        prepareCoefficientStorage(chain);
+        chain.prepare(spec);
+
+        updateLowCutFilter(chain.get<ChainPositions::LowCut>(), designed.lowCut, settings);
+        updateCoefficients(chain.get<ChainPositions::Peak>().coefficients, designed.peak);
+        updateHighCutFilter(chain.get<ChainPositions::HighCut>(), designed.highCut, settings);
+    }
+
+    inline CascadeCoefficients<float> makeCascadeCoefficients(const DesignedCoefficients& designed)
+    {
+        CascadeCoefficients<float> coefficients;
+        coefficients.setLowCut(designed.lowCut);
+        coefficients.setPeak(designed.peak);
+        coefficients.setHighCut(designed.highCut);
+        return coefficients;
+    }
+}
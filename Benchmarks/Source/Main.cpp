@@ -0,0 +1,756 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Benchmarks for the SimpleEQ DSP path.
+
+  ==============================================================================
+*/
+
+#include "BenchmarkHelpers.h"
+
+using namespace Benchmark;
+
+namespace
+{
+    constexpr double comparisonSampleRate = 48000.0;
+
+    //==============================================================================
+    /**
+     processBlock and the MonoChain on their own, across every LowCut/HighCut slope combination,
+     block sizes 16..8192 and 44.1/48/96/192 kHz.
+     */
+    void runMatrix(Report& report)
+    {
+        std::cout << "target\tlow cut\thigh cut\trate\tblock\tns/sample\tcycles/sample" << std::endl;
+
+        juce::MidiBuffer midi;
+
+        for( auto sampleRate : { 44100.0, 48000.0, 96000.0, 192000.0 } )
+        {
+            for( int blockSize = 16; blockSize <= 8192; blockSize *= 2 )
+            {
+                juce::AudioBuffer<float> source(2, blockSize), buffer(2, blockSize);
+                fillWithNoise(source);
+
+                for( int lowCutSlope = Slope::Slope_12; lowCutSlope <= Slope::Slope_96; ++lowCutSlope )
+                {
+                    for( int highCutSlope = Slope::Slope_12; highCutSlope <= Slope::Slope_96; ++highCutSlope )
+                    {
+                        auto settings = makeSettings(lowCutSlope, highCutSlope);
+
+                        juce::NamedValueSet parameters;
+                        parameters.set("lowCutSlope", slopeInDecibelsPerOctave(lowCutSlope));
+                        parameters.set("highCutSlope", slopeInDecibelsPerOctave(highCutSlope));
+                        parameters.set("sampleRate", sampleRate);
+                        parameters.set("blockSize", blockSize);
+
+                        auto print = [&](const char* target, const Measurement& m)
+                        {
+                            std::cout << target << "\t" << slopeInDecibelsPerOctave(lowCutSlope) << "\t" << slopeInDecibelsPerOctave(highCutSlope)
+                                      << "\t" << sampleRate << "\t" << blockSize << "\t" << m.nsPerSample << "\t" << m.cyclesPerSample << std::endl;
+                        };
+
+                        //whole processor, stereo, parameters set the way a host would
+                        {
+                            SimpleEQAudioProcessor processor;
+                            applySettings(processor, settings);
+                            processor.prepareToPlay(sampleRate, blockSize);
+
+                            auto m = measure([&]
+                            {
+                                buffer.makeCopyOf(source, true);
+                                processor.processBlock(buffer, midi);
+                            }, (size_t) blockSize);
+
+                            report.add("processBlock", parameters, m);
+                            print("processBlock", m);
+                        }
+
+                        //one MonoChain, one channel
+                        {
+                            juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) blockSize, 1 };
+                            MonoChain chain;
+                            prepareMonoChain(chain, settings, designAll(settings, sampleRate), spec);
+
+                            auto m = measure([&]
+                            {
+                                buffer.copyFrom(0, 0, source, 0, 0, blockSize);
+                                auto block = juce::dsp::AudioBlock<float>(buffer).getSingleChannelBlock(0);
+                                chain.process(juce::dsp::ProcessContextReplacing<float>(block));
+                            }, (size_t) blockSize);
+
+                            report.add("MonoChain", parameters, m);
+                            print("MonoChain", m);
+                        }
+                    }
+                }
+            }
+        }
+
+        std::cout << std::endl;
+    }
+
+    //==============================================================================
+    //MonoChain (one ProcessorChain pass per section) against FusedBiquadCascade (one sweep for all sections)
+    void benchmarkFusedCascade(Report& report)
+    {
+        std::cout << "Fused cascade vs MonoChain, mono, 48 dB/oct low + high cut + peak @ 48 kHz" << std::endl;
+        std::cout << "block\tMonoChain ns/sample\tfused ns/sample\tspeedup\tmax |diff|" << std::endl;
+
+        auto settings = makeSettings();
+        auto designed = designAll(settings, comparisonSampleRate);
+
+        for( auto blockSize : { 512, 4096 } )
+        {
+            juce::dsp::ProcessSpec spec { comparisonSampleRate, (juce::uint32) blockSize, 1 };
+
+            juce::AudioBuffer<float> source(1, blockSize), chainBuffer(1, blockSize), fusedBuffer(1, blockSize);
+            fillWithNoise(source);
+
+            MonoChain chain;
+            prepareMonoChain(chain, settings, designed, spec);
+
+            auto coefficients = makeCascadeCoefficients(designed);
+            FusedBiquadCascade<float> fused;
+
+            //same input through both from a clean state, the outputs should match
+            chainBuffer.makeCopyOf(source);
+            fusedBuffer.makeCopyOf(source);
+            {
+                juce::dsp::AudioBlock<float> block(chainBuffer);
+                juce::dsp::ProcessContextReplacing<float> context(block);
+                chain.process(context);
+                fused.process(coefficients, fusedBuffer.getWritePointer(0), (size_t) blockSize);
+            }
+
+            float maxDifference = 0.f;
+            for( int i = 0; i < blockSize; ++i )
+                maxDifference = juce::jmax(maxDifference, std::abs(chainBuffer.getSample(0, i) - fusedBuffer.getSample(0, i)));
+
+            auto chainM = measure([&]
+            {
+                chainBuffer.copyFrom(0, 0, source, 0, 0, blockSize);
+                juce::dsp::AudioBlock<float> block(chainBuffer);
+                juce::dsp::ProcessContextReplacing<float> context(block);
+                chain.process(context);
+            }, (size_t) blockSize);
+
+            auto fusedM = measure([&]
+            {
+                fusedBuffer.copyFrom(0, 0, source, 0, 0, blockSize);
+                fused.process(coefficients, fusedBuffer.getWritePointer(0), (size_t) blockSize);
+            }, (size_t) blockSize);
+
+            juce::NamedValueSet parameters;
+            parameters.set("blockSize", blockSize);
+            report.add("MonoChain (fused comparison)", parameters, chainM);
+            report.add("FusedBiquadCascade", parameters, fusedM);
+
+            std::cout << blockSize << "\t" << chainM.nsPerSample << "\t" << fusedM.nsPerSample << "\t"
+                      << chainM.nsPerSample / fusedM.nsPerSample << "x\t" << maxDifference << std::endl;
+        }
+
+        std::cout << std::endl;
+    }
+
+    //two MonoChains back to back (the old processBlock) against the ChainBank running L/R in SIMD lanes
+    void benchmarkStereoSIMD(Report& report)
+    {
+        std::cout << "ChainBank vs left/right MonoChain, stereo, 48 dB/oct low + high cut + peak @ 48 kHz" << std::endl;
+        std::cout << "block\tMonoChain x2 ns/sample\tSIMD ns/sample\tspeedup" << std::endl;
+
+        auto settings = makeSettings();
+        auto designed = designAll(settings, comparisonSampleRate);
+
+        for( auto blockSize : { 64, 512, 4096 } )
+        {
+            juce::dsp::ProcessSpec spec { comparisonSampleRate, (juce::uint32) blockSize, 2 };
+
+            juce::AudioBuffer<float> source(2, blockSize), buffer(2, blockSize);
+            fillWithNoise(source);
+
+            MonoChain leftChain, rightChain;
+            prepareMonoChain(leftChain, settings, designed, spec);
+            prepareMonoChain(rightChain, settings, designed, spec);
+
+            ChainBank bank;
+            bank.prepare(spec);
+            bank.setLowCut(designed.lowCut);
+            bank.setPeak(designed.peak);
+            bank.setHighCut(designed.highCut);
+
+            auto chainM = measure([&]
+            {
+                buffer.makeCopyOf(source, true);
+                juce::dsp::AudioBlock<float> block(buffer);
+                auto leftBlock = block.getSingleChannelBlock(0);
+                auto rightBlock = block.getSingleChannelBlock(1);
+                leftChain.process(juce::dsp::ProcessContextReplacing<float>(leftBlock));
+                rightChain.process(juce::dsp::ProcessContextReplacing<float>(rightBlock));
+            }, (size_t) blockSize);
+
+            auto simdM = measure([&]
+            {
+                buffer.makeCopyOf(source, true);
+                juce::dsp::AudioBlock<float> block(buffer);
+                bank.process(block);
+            }, (size_t) blockSize);
+
+            juce::NamedValueSet parameters;
+            parameters.set("blockSize", blockSize);
+            report.add("MonoChain x2 (stereo comparison)", parameters, chainM);
+            report.add("ChainBank stereo", parameters, simdM);
+
+            std::cout << blockSize << "\t" << chainM.nsPerSample << "\t" << simdM.nsPerSample << "\t"
+                      << chainM.nsPerSample / simdM.nsPerSample << "x" << std::endl;
+        }
+
+        std::cout << std::endl;
+    }
+
+    //what sub-block smoothing costs on top of the block-rate path while all three bands are being automated
+    void benchmarkSmoothing(Report& report)
+    {
+        std::cout << "Sub-block smoothing vs block-rate updates, stereo, 512 sample host blocks, every band automated" << std::endl;
+        std::cout << "sub-block\tns/sample\toverhead" << std::endl;
+
+        constexpr int blockSize = 512;
+
+        juce::AudioBuffer<float> source(2, blockSize), buffer(2, blockSize);
+        fillWithNoise(source);
+        juce::MidiBuffer midi;
+
+        double blockRateNs = 0.0;
+
+        for( auto subBlockSize : { 0, 64, 32, 16, 8 } )
+        {
+            SimpleEQAudioProcessor processor;
+            processor.setSmoothingSubBlockSize(subBlockSize);
+            processor.setBypassTolerance(-1.f); //the peak sits at 0 dB, keep it running so every band really ramps
+            processor.prepareToPlay(comparisonSampleRate, blockSize);
+
+            auto* lowCutFreq = processor.apvts.getParameter("LowCut Freq");
+            auto* peakFreq = processor.apvts.getParameter("Peak Freq");
+            auto* highCutFreq = processor.apvts.getParameter("HighCut Freq");
+
+            int counter = 0;
+            auto m = measure([&]
+            {
+                //new values every block so every block starts a fresh ramp
+                auto position = float(counter++ % 64) / 63.f;
+                lowCutFreq->setValueNotifyingHost(position * 0.3f);
+                peakFreq->setValueNotifyingHost(0.3f + position * 0.4f);
+                highCutFreq->setValueNotifyingHost(1.f - position * 0.3f);
+
+                buffer.makeCopyOf(source, true);
+                processor.processBlock(buffer, midi);
+            }, (size_t) blockSize);
+
+            if( subBlockSize == 0 )
+                blockRateNs = m.nsPerSample;
+
+            juce::NamedValueSet parameters;
+            parameters.set("subBlockSize", subBlockSize);
+            report.add("smoothing", parameters, m);
+
+            std::cout << (subBlockSize == 0 ? juce::String("block-rate") : juce::String(subBlockSize)) << "\t"
+                      << m.nsPerSample << "\t" << juce::String((m.nsPerSample / blockRateNs - 1.0) * 100.0, 1) << "%" << std::endl;
+        }
+
+        std::cout << std::endl;
+    }
+
+    //the FIR mode against the IIR it replaces. the convolver works in whole partitions, so small host blocks
+    //just spread the same per-partition cost, the interesting number is how many instances fit on a core
+    void benchmarkLinearPhase(Report& report)
+    {
+        std::cout << "LinearPhaseEQ vs ChainBank, stereo, 48 dB/oct low + high cut + peak @ 48 kHz, "
+                  << LinearPhaseEQ::getKernelLength(comparisonSampleRate) << " taps" << std::endl;
+        std::cout << "block\tChainBank ns/sample\tlinear phase ns/sample\tratio\tinstances/core" << std::endl;
+
+        auto settings = makeSettings();
+        auto designed = designAll(settings, comparisonSampleRate);
+
+        for( auto blockSize : { 64, 512, 4096 } )
+        {
+            juce::dsp::ProcessSpec spec { comparisonSampleRate, (juce::uint32) blockSize, 2 };
+
+            juce::AudioBuffer<float> source(2, blockSize), buffer(2, blockSize);
+            fillWithNoise(source);
+
+            ChainBank bank;
+            bank.prepare(spec);
+            bank.setLowCut(designed.lowCut);
+            bank.setPeak(designed.peak);
+            bank.setHighCut(designed.highCut);
+
+            LinearPhaseEQ linearPhase([&settings](double sampleRate) { return designCascade(settings, sampleRate); });
+            linearPhase.prepare(comparisonSampleRate, 2);
+            linearPhase.setEnabled(true);
+
+            //the convolvers and the first kernel are built on the design thread
+            while (! linearPhase.isReady())
+                juce::Thread::sleep(1);
+
+            auto iirM = measure([&]
+            {
+                buffer.makeCopyOf(source, true);
+                juce::dsp::AudioBlock<float> block(buffer);
+                bank.process(block);
+            }, (size_t) blockSize);
+
+            auto firM = measure([&]
+            {
+                buffer.makeCopyOf(source, true);
+                juce::dsp::AudioBlock<float> block(buffer);
+                linearPhase.process(block);
+            }, (size_t) blockSize);
+
+            juce::NamedValueSet parameters;
+            parameters.set("blockSize", blockSize);
+            report.add("ChainBank stereo (linear phase comparison)", parameters, iirM);
+            report.add("LinearPhaseEQ stereo", parameters, firM);
+
+            //one second of 48 kHz audio per second of one core
+            const auto instancesPerCore = 1.0e9 / (firM.nsPerSample * comparisonSampleRate);
+
+            std::cout << blockSize << "\t" << iirM.nsPerSample << "\t" << firM.nsPerSample << "\t"
+                      << firM.nsPerSample / iirM.nsPerSample << "x\t" << juce::String(instancesPerCore, 1) << std::endl;
+        }
+
+        std::cout << std::endl;
+    }
+
+    //the processor in single against double precision, at the settings where float biquads struggle: a 48 dB/oct low cut
+    //at 20 Hz, where the poles crowd up against z = 1 as the sample rate goes up
+    void benchmarkDoublePrecision(Report& report)
+    {
+        std::cout << "processBlock float vs double, stereo, 512 sample blocks, 20 Hz 48 dB/oct low cut + peak + high cut" << std::endl;
+        std::cout << "rate\tfloat ns/sample\tdouble ns/sample\tcost\tfloat error vs double" << std::endl;
+
+        constexpr int blockSize = 512;
+        auto settings = makeSettings();
+        settings.lowCutFreq = 20.f;
+
+        juce::MidiBuffer midi;
+
+        for( auto sampleRate : { 48000.0, 192000.0 } )
+        {
+            SimpleEQAudioProcessor floatProcessor, doubleProcessor;
+            floatProcessor.setProcessingPrecision(juce::AudioProcessor::singlePrecision);
+            doubleProcessor.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+
+            for( auto* processor : { &floatProcessor, &doubleProcessor } )
+            {
+                applySettings(*processor, settings);
+                processor->prepareToPlay(sampleRate, blockSize);
+            }
+
+            //two seconds of the same noise through both, the double output is the reference
+            double errorSquared = 0.0, referenceSquared = 0.0;
+            {
+                const auto numBlocks = juce::roundToInt(2.0 * sampleRate / blockSize);
+                juce::AudioBuffer<float> floatBuffer(2, blockSize);
+                juce::AudioBuffer<double> doubleBuffer(2, blockSize);
+                juce::Random random(0x5eed);
+
+                for( int b = 0; b < numBlocks; ++b )
+                {
+                    for( int ch = 0; ch < 2; ++ch )
+                    {
+                        for( int i = 0; i < blockSize; ++i )
+                        {
+                            auto sample = random.nextFloat() * 2.f - 1.f;
+                            floatBuffer.setSample(ch, i, sample);
+                            doubleBuffer.setSample(ch, i, sample);
+                        }
+                    }
+
+                    floatProcessor.processBlock(floatBuffer, midi);
+                    doubleProcessor.processBlock(doubleBuffer, midi);
+
+                    for( int ch = 0; ch < 2; ++ch )
+                    {
+                        for( int i = 0; i < blockSize; ++i )
+                        {
+                            auto reference = doubleBuffer.getSample(ch, i);
+                            auto error = double(floatBuffer.getSample(ch, i)) - reference;
+                            errorSquared += error * error;
+                            referenceSquared += reference * reference;
+                        }
+                    }
+                }
+            }
+
+            juce::AudioBuffer<float> floatSource(2, blockSize), floatBuffer(2, blockSize);
+            juce::AudioBuffer<double> doubleSource(2, blockSize), doubleBuffer(2, blockSize);
+            fillWithNoise(floatSource);
+            fillWithNoise(doubleSource);
+
+            auto floatM = measure([&]
+            {
+                floatBuffer.makeCopyOf(floatSource, true);
+                floatProcessor.processBlock(floatBuffer, midi);
+            }, (size_t) blockSize);
+
+            auto doubleM = measure([&]
+            {
+                doubleBuffer.makeCopyOf(doubleSource, true);
+                doubleProcessor.processBlock(doubleBuffer, midi);
+            }, (size_t) blockSize);
+
+            const auto errorInDecibels = juce::Decibels::gainToDecibels(std::sqrt(errorSquared / referenceSquared), -200.0);
+
+            juce::NamedValueSet parameters;
+            parameters.set("sampleRate", sampleRate);
+            report.add("processBlock float (precision comparison)", parameters, floatM);
+            report.add("processBlock double", parameters, doubleM);
+
+            std::cout << sampleRate << "\t" << floatM.nsPerSample << "\t" << doubleM.nsPerSample << "\t"
+                      << doubleM.nsPerSample / floatM.nsPerSample << "x\t" << juce::String(errorInDecibels, 1) << " dB" << std::endl;
+        }
+
+        std::cout << std::endl;
+    }
+
+    //what it costs to move the peak frequency every sample: the biquad path has to redesign (sin/cos, divides) and
+    //re-run its coefficient setup per sample, the SVF only needs g = tan(pi f / fs) and a divide per section
+    void benchmarkAudioRateModulation(Report& report)
+    {
+        std::cout << "SVFBank vs FusedBiquadCascade, mono, 48 dB/oct low + high cut + peak @ 48 kHz, 512 sample blocks" << std::endl;
+        std::cout << "peak freq\tbiquad ns/sample\tSVF ns/sample\tspeedup\tmax |diff| (double)" << std::endl;
+
+        constexpr int blockSize = 512;
+        auto settings = makeSettings();
+        auto designed = designAll(settings, comparisonSampleRate);
+        const auto peakGain = juce::Decibels::decibelsToGain(settings.peakGainInDecibels);
+
+        //a 5 Hz LFO sweeping the peak three octaves either side of 750 Hz, one block's worth per call, looping over a second
+        std::vector<float> sweep((size_t) comparisonSampleRate);
+        for( size_t i = 0; i < sweep.size(); ++i )
+            sweep[i] = settings.peakFreq * std::exp2(3.f * std::sin(juce::MathConstants<float>::twoPi * 5.f * float(i) / float(comparisonSampleRate)));
+
+        //same noise through both in double from a clean state, the responses should be the same up to rounding
+        double maxDifference = 0.0;
+        {
+            juce::AudioBuffer<double> biquadBuffer(1, blockSize), svfBuffer(1, blockSize);
+            fillWithNoise(biquadBuffer);
+            svfBuffer.makeCopyOf(biquadBuffer);
+
+            FusedBiquadCascade<double> fused;
+            fused.process(designCascade<double>(settings, comparisonSampleRate), biquadBuffer.getWritePointer(0), (size_t) blockSize);
+
+            SVFBank<double> svf;
+            svf.prepare({ comparisonSampleRate, (juce::uint32) blockSize, 1 });
+            svf.setLowCut(settings.lowCutFreq, getCutOrder(settings.lowCutSlope));
+            svf.setHighCut(settings.highCutFreq, getCutOrder(settings.highCutSlope));
+            svf.setPeak(settings.peakFreq, settings.peakQuality, peakGain);
+            svf.process(juce::dsp::AudioBlock<double>(svfBuffer));
+
+            for( int i = 0; i < blockSize; ++i )
+                maxDifference = juce::jmax(maxDifference, std::abs(biquadBuffer.getSample(0, i) - svfBuffer.getSample(0, i)));
+        }
+
+        juce::AudioBuffer<float> source(1, blockSize), buffer(1, blockSize);
+        fillWithNoise(source);
+
+        auto coefficients = makeCascadeCoefficients(designed);
+        FusedBiquadCascade<float> fused;
+
+        SVFBank<float> svf;
+        svf.prepare({ comparisonSampleRate, (juce::uint32) blockSize, 1 });
+        svf.setLowCut(settings.lowCutFreq, getCutOrder(settings.lowCutSlope));
+        svf.setHighCut(settings.highCutFreq, getCutOrder(settings.highCutSlope));
+        svf.setPeak(settings.peakFreq, settings.peakQuality, peakGain);
+
+        for( auto modulated : { false, true } )
+        {
+            size_t position = 0;
+            auto nextSweep = [&]
+            {
+                auto* frequencies = sweep.data() + position;
+                position = position + 2 * blockSize > sweep.size() ? 0 : position + blockSize;
+                return frequencies;
+            };
+
+            auto biquadM = measure([&]
+            {
+                buffer.copyFrom(0, 0, source, 0, 0, blockSize);
+                auto* data = buffer.getWritePointer(0);
+
+                if( ! modulated )
+                {
+                    fused.process(coefficients, data, (size_t) blockSize);
+                    return;
+                }
+
+                auto* frequencies = nextSweep();
+                BiquadCoefficients<float> peak;
+                for( int i = 0; i < blockSize; ++i )
+                {
+                    CoefficientDesign::makePeak(peak, comparisonSampleRate, frequencies[i], settings.peakQuality, peakGain);
+                    coefficients.setPeak(peak);
+                    fused.process(coefficients, data + i, 1);
+                }
+            }, (size_t) blockSize);
+
+            auto svfM = measure([&]
+            {
+                buffer.copyFrom(0, 0, source, 0, 0, blockSize);
+                svf.process(juce::dsp::AudioBlock<float>(buffer), nullptr, modulated ? nextSweep() : nullptr, nullptr);
+            }, (size_t) blockSize);
+
+            juce::NamedValueSet parameters;
+            parameters.set("peakFrequency", modulated ? "per sample" : "fixed");
+            report.add("FusedBiquadCascade (modulation comparison)", parameters, biquadM);
+            report.add("SVFBank", parameters, svfM);
+
+            std::cout << (modulated ? "per sample" : "fixed") << "\t" << biquadM.nsPerSample << "\t" << svfM.nsPerSample << "\t"
+                      << biquadM.nsPerSample / svfM.nsPerSample << "x\t" << maxDifference << std::endl;
+        }
+
+        std::cout << std::endl;
+    }
+
+    //the plugin as it's inserted: default parameters, the 0 dB peak drops out, the cuts at the ends of their range keep running
+    void benchmarkIdentityBypass(Report& report)
+    {
+        std::cout << "Identity bypass, default parameters, stereo, 512 sample blocks @ 48 kHz" << std::endl;
+        std::cout << "bypass\tns/sample" << std::endl;
+
+        constexpr int blockSize = 512;
+
+        juce::AudioBuffer<float> source(2, blockSize), buffer(2, blockSize);
+        fillWithNoise(source);
+        juce::MidiBuffer midi;
+
+        for( auto tolerance : { -1.f, 0.05f } )
+        {
+            SimpleEQAudioProcessor processor;
+            processor.setBypassTolerance(tolerance);
+            processor.prepareToPlay(comparisonSampleRate, blockSize);
+
+            auto m = measure([&]
+            {
+                buffer.makeCopyOf(source, true);
+                processor.processBlock(buffer, midi);
+            }, (size_t) blockSize);
+
+            juce::NamedValueSet parameters;
+            parameters.set("bypassTolerance", tolerance);
+            report.add("identity bypass", parameters, m);
+
+            std::cout << (tolerance < 0.f ? "off" : "on") << "\t" << m.nsPerSample << std::endl;
+        }
+
+        std::cout << std::endl;
+    }
+
+    //a long silence in a stem: what processBlock costs once the tail has rung out, with and without sleeping
+    void benchmarkSleep(Report& report)
+    {
+        std::cout << "Sleep on silent input, 96 dB/oct low + high cut + peak, stereo, 512 sample blocks @ 48 kHz" << std::endl;
+        std::cout << "sleep\ttail (s)\tns/sample" << std::endl;
+
+        constexpr int blockSize = 512;
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+
+        for( auto sleep : { false, true } )
+        {
+            SimpleEQAudioProcessor processor;
+            processor.setSleepEnabled(sleep);
+            applySettings(processor, makeSettings());
+            processor.prepareToPlay(comparisonSampleRate, blockSize);
+
+            //ring out first, the measurement is the silence after the tail
+            const auto tailBlocks = (int) std::ceil(processor.getTailLengthSeconds() * comparisonSampleRate / blockSize) + 1;
+            for( int i = 0; i < tailBlocks; ++i )
+            {
+                buffer.clear();
+                processor.processBlock(buffer, midi);
+            }
+
+            auto m = measure([&]
+            {
+                buffer.clear();
+                processor.processBlock(buffer, midi);
+            }, (size_t) blockSize);
+
+            juce::NamedValueSet parameters;
+            parameters.set("sleep", sleep);
+            report.add("silent input", parameters, m);
+
+            std::cout << (sleep ? "on" : "off") << "\t" << processor.getTailLengthSeconds() << "\t" << m.nsPerSample << std::endl;
+        }
+
+        std::cout << std::endl;
+    }
+
+    //mono content on a stereo bus. the SVFs run channels one by one, detection is on by default because it wins there.
+    //the biquads already run both channels in one SIMD register, detection is skipped for them and both rows should match
+    void benchmarkDualMono(Report& report)
+    {
+        std::cout << "Dual mono detection, identical L/R, 96 dB/oct low + high cut + peak, 512 sample blocks @ 48 kHz" << std::endl;
+        std::cout << "topology\toff ns/sample\ton ns/sample\tspeedup" << std::endl;
+
+        constexpr int blockSize = 512;
+
+        juce::AudioBuffer<float> source(2, blockSize), buffer(2, blockSize);
+        fillWithNoise(source);
+        source.copyFrom(1, 0, source, 0, 0, blockSize);
+        juce::MidiBuffer midi;
+
+        using Topology = SimpleEQAudioProcessor::FilterTopology;
+
+        for( auto topology : { Topology::biquad, Topology::stateVariable } )
+        {
+            std::array<Measurement, 2> measurements;
+
+            for( auto detect : { false, true } )
+            {
+                SimpleEQAudioProcessor processor;
+                processor.setFilterTopology(topology);
+                processor.setDualMonoDetection(detect);
+                applySettings(processor, makeSettings());
+                processor.prepareToPlay(comparisonSampleRate, blockSize);
+
+                auto m = measure([&]
+                {
+                    buffer.makeCopyOf(source, true);
+                    processor.processBlock(buffer, midi);
+                }, (size_t) blockSize);
+
+                juce::NamedValueSet parameters;
+                parameters.set("topology", topology == Topology::biquad ? "biquad" : "SVF");
+                parameters.set("dualMonoDetection", detect);
+                report.add("dual mono", parameters, m);
+
+                measurements[detect ? 1 : 0] = m;
+            }
+
+            std::cout << (topology == Topology::biquad ? "biquad" : "SVF") << "\t" << measurements[0].nsPerSample << "\t"
+                      << measurements[1].nsPerSample << "\t" << measurements[0].nsPerSample / measurements[1].nsPerSample << "x" << std::endl;
+        }
+
+        std::cout << std::endl;
+    }
+
+   #if SIMPLEEQ_RT_CHECKS
+    //the detector's own test: things processBlock must never do, done on purpose inside a realtime scope
+    bool checkRealtimeSafetyDetector()
+    {
+        struct alignas(64) OverAligned { float lanes[16]; };
+        static void* volatile escape = nullptr; //keeps the compiler from eliding the allocations
+
+        auto& log = RealtimeSafety::getEventLog();
+        juce::AudioBuffer<float> buffer(2, 16);
+        juce::CriticalSection lock;
+        bool passed = true;
+
+        auto check = [&](const char* what, auto&& action, int (RealtimeSafety::EventLog::*count)() const noexcept)
+        {
+            log.reset();
+            {
+                RealtimeSafety::ScopedRealtimeScope realtimeScope;
+                action();
+            }
+
+            const auto caught = (log.*count)() > 0;
+            passed = passed && caught;
+            std::cout << "realtime safety detector: " << what << (caught ? " caught" : " MISSED") << std::endl;
+        };
+
+        check("over-aligned new", [&] { auto* p = new OverAligned; escape = p; delete p; },
+              &RealtimeSafety::EventLog::getNumAllocations);
+
+        //malloc and pthread locks are only hooked here, see RealtimeSafety.cpp
+       #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+        //malloc through HeapBlock, the Fifo::push copy-assignment case
+        check("AudioBuffer resize", [&] { buffer.setSize(2, 1 << 16); escape = buffer.getWritePointer(0); },
+              &RealtimeSafety::EventLog::getNumAllocations);
+        check("CriticalSection::tryEnter", [&] { if( lock.tryEnter() ) lock.exit(); },
+              &RealtimeSafety::EventLog::getNumLocks);
+       #else
+        juce::ignoreUnused(buffer, lock);
+       #endif
+
+        log.reset();
+        return passed;
+    }
+   #endif
+
+    void printUsage()
+    {
+        std::cout << "usage: SimpleEQBenchmarks [--suite all|matrix|comparisons] [--json <file>] [--min-time <seconds>]" << std::endl
+                  << "  --suite     matrix: processBlock and MonoChain over slopes x block sizes x sample rates" << std::endl
+                  << "              comparisons: fused cascade, SIMD stereo, smoothing, linear phase, double precision, SVF modulation, identity bypass, sleep and dual mono comparisons" << std::endl
+                  << "  --json      write every measurement to <file> so runs can be diffed between commits" << std::endl
+                  << "  --min-time  wall clock per measurement (default 0.25)" << std::endl;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    //the processor's parameter tree needs a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args(argc, argv);
+
+    if( args.containsOption("--help|-h") )
+    {
+        printUsage();
+        return 0;
+    }
+
+    if( args.containsOption("--min-time") )
+        minSecondsPerMeasurement = juce::jmax(0.001, args.getValueForOption("--min-time").getDoubleValue());
+
+    auto suite = args.containsOption("--suite") ? args.getValueForOption("--suite") : juce::String("all");
+
+   #if SIMPLEEQ_RT_CHECKS
+    //a report of zero events only means something if the detector can see what it's looking for
+    if( ! checkRealtimeSafetyDetector() )
+        return 1;
+   #endif
+
+    Report report;
+
+    if( suite == "all" || suite == "comparisons" )
+    {
+        benchmarkFusedCascade(report);
+        benchmarkStereoSIMD(report);
+        benchmarkSmoothing(report);
+        benchmarkLinearPhase(report);
+        benchmarkDoublePrecision(report);
+        benchmarkAudioRateModulation(report);
+        benchmarkIdentityBypass(report);
+        benchmarkSleep(report);
+        benchmarkDualMono(report);
+    }
+
+    if( suite == "all" || suite == "matrix" )
+        runMatrix(report);
+
+   #if SIMPLEEQ_RT_CHECKS
+    //profiling build: everything processBlock allocated or locked across the whole run
+    std::cout << RealtimeSafety::getEventLog().createReport() << std::endl;
+   #endif
+
+    if( args.containsOption("--json") )
+    {
+        auto jsonFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--json"));
+        if( ! jsonFile.replaceWithText(report.toJSON()) )
+        {
+            std::cerr << "can't write " << jsonFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        std::cout << "wrote " << jsonFile.getFullPathName() << std::endl;
+    }
+
+    return 0;
+}
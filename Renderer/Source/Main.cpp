@@ -0,0 +1,293 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Headless offline renderer: runs a directory of WAV/AIFF files through
+    SimpleEQAudioProcessor with a preset, one processor per worker thread.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+namespace
+{
+    juce::CriticalSection outputLock;
+
+    void log(const juce::String& message)
+    {
+        const juce::ScopedLock sl(outputLock);
+        std::cout << message << std::endl;
+    }
+
+    struct RenderSettings
+    {
+        juce::MemoryBlock preset; //getStateInformation() blob, empty = default parameters
+        juce::File outputDirectory;
+        int blockSize = 8192;
+    };
+
+    /**
+     owns one SimpleEQAudioProcessor (no editor is ever created) and keeps pulling
+     files off the shared list until there are none left.
+     */
+    class RenderWorker : public juce::Thread
+    {
+    public:
+        RenderWorker(int index,
+                     const RenderSettings& renderSettings,
+                     const juce::Array<juce::File>& filesToRender,
+                     std::atomic<int>& nextFileIndex,
+                     juce::AudioFormatManager& formatManager) :
+        juce::Thread("SimpleEQ render worker " + juce::String(index)),
+        settings(renderSettings),
+        files(filesToRender),
+        nextFile(nextFileIndex),
+        formats(formatManager)
+        {
+            //constructed on the main thread, the parameter tree is happier there
+            if( settings.preset.getSize() > 0 )
+                processor.setStateInformation(settings.preset.getData(), (int) settings.preset.getSize());
+        }
+
+        ~RenderWorker() override
+        {
+            stopThread(-1);
+        }
+
+        void run() override
+        {
+            while( ! threadShouldExit() )
+            {
+                auto index = nextFile++;
+                if( index >= files.size() )
+                    break;
+
+                if( ! render(files[index]) )
+                    ++numFailures;
+            }
+        }
+
+        int getNumFailures() const { return numFailures; }
+        double getAudioSecondsRendered() const { return audioSecondsRendered; }
+
+    private:
+        const RenderSettings& settings;
+        const juce::Array<juce::File>& files;
+        std::atomic<int>& nextFile;
+        juce::AudioFormatManager& formats;
+
+        SimpleEQAudioProcessor processor;
+
+        int numFailures = 0;
+        double audioSecondsRendered = 0.0;
+
+        bool fail(const juce::File& file, const juce::String& reason)
+        {
+            log("FAILED  " + file.getFileName() + ": " + reason);
+            return false;
+        }
+
+        bool render(const juce::File& inputFile)
+        {
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(inputFile));
+            if( reader == nullptr )
+                return fail(inputFile, "unreadable or unsupported format");
+
+            auto* format = formats.findFormatForFileExtension(inputFile.getFileExtension());
+            if( format == nullptr )
+                return fail(inputFile, "no writer for " + inputFile.getFileExtension());
+
+            const auto numChannels = (int) reader->numChannels;
+            const auto sampleRate = reader->sampleRate;
+            const auto length = reader->lengthInSamples;
+            const auto blockSize = settings.blockSize;
+
+            auto outputFile = settings.outputDirectory.getChildFile(inputFile.getFileName());
+            if( outputFile == inputFile )
+                return fail(inputFile, "would overwrite its own source");
+
+            //written next to the target and only moved over it once complete, nothing is replaced by a failed render
+            juce::TemporaryFile temporaryFile(outputFile);
+
+            auto stream = std::make_unique<juce::FileOutputStream>(temporaryFile.getFile());
+            if( stream->failedToOpen() )
+                return fail(inputFile, "can't open " + temporaryFile.getFile().getFullPathName());
+
+            std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(),
+                                                                                    sampleRate,
+                                                                                    (unsigned int) numChannels,
+                                                                                    (int) reader->bitsPerSample,
+                                                                                    reader->metadataValues,
+                                                                                    0));
+            if( writer == nullptr )
+                return fail(inputFile, "can't write " + juce::String(numChannels) + " channels at " + juce::String(reader->bitsPerSample) + " bits");
+
+            stream.release(); //the writer owns it now
+
+            //the bus layout follows the file, any channel count is supported
+            processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+            processor.setNonRealtime(true); //faster than realtime, nothing may depend on background threads keeping up
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            juce::AudioBuffer<float> buffer(numChannels, blockSize);
+            juce::MidiBuffer midi;
+
+            //drop the processor's latency from the front and flush it out with silence at the end, so output lines up with input
+            juce::int64 samplesToDrop = processor.getLatencySamples();
+            juce::int64 readPosition = 0, samplesWritten = 0;
+            juce::int64 dspTicks = 0;
+
+            while( samplesWritten < length )
+            {
+                auto numToRead = (int) juce::jlimit<juce::int64>(0, blockSize, length - readPosition);
+
+                buffer.clear();
+                if( numToRead > 0 )
+                {
+                    reader->read(&buffer, 0, numToRead, readPosition, true, true);
+                    readPosition += numToRead;
+                }
+
+                auto dspStart = juce::Time::getHighResolutionTicks();
+                processor.processBlock(buffer, midi);
+                dspTicks += juce::Time::getHighResolutionTicks() - dspStart;
+
+                auto skip = (int) juce::jmin<juce::int64>(samplesToDrop, blockSize);
+                samplesToDrop -= skip;
+
+                auto numToWrite = (int) juce::jmin<juce::int64>(blockSize - skip, length - samplesWritten);
+                if( numToWrite > 0 )
+                {
+                    if( ! writer->writeFromAudioSampleBuffer(buffer, skip, numToWrite) )
+                        return fail(inputFile, "write error");
+
+                    samplesWritten += numToWrite;
+                }
+            }
+
+            writer.reset();
+            processor.releaseResources();
+
+            if( ! temporaryFile.overwriteTargetFileWithTemporary() )
+                return fail(inputFile, "can't replace " + outputFile.getFullPathName());
+
+            auto audioSeconds = double(length) / sampleRate;
+            auto totalSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+            auto dspSeconds = juce::Time::highResolutionTicksToSeconds(dspTicks);
+            audioSecondsRendered += audioSeconds;
+
+            log(juce::String("OK      ") + inputFile.getFileName()
+                + "  " + juce::String(numChannels) + "ch " + juce::String(sampleRate, 0) + " Hz "
+                + juce::String(audioSeconds, 2) + " s"
+                + "  realtime x" + juce::String(audioSeconds / juce::jmax(totalSeconds, 1.0e-9), 1)
+                + " (dsp only x" + juce::String(audioSeconds / juce::jmax(dspSeconds, 1.0e-9), 1) + ")");
+
+            return true;
+        }
+
+        JUCE_DECLARE_NON_COPYABLE (RenderWorker)
+    };
+
+    void printUsage()
+    {
+        std::cout << "usage: SimpleEQRenderer --input <dir> --output <dir> [--preset <file>] [--threads <n>] [--block-size <n>]" << std::endl
+                  << "  --preset      state blob saved from getStateInformation()" << std::endl
+                  << "  --threads     worker count, one processor each (default: number of CPUs)" << std::endl
+                  << "  --block-size  samples per processBlock call (default: 8192)" << std::endl;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args(argc, argv);
+
+    if( args.containsOption("--help|-h") || ! args.containsOption("--input") || ! args.containsOption("--output") )
+    {
+        printUsage();
+        return 1;
+    }
+
+    auto cwd = juce::File::getCurrentWorkingDirectory();
+    auto inputDirectory = cwd.getChildFile(args.getValueForOption("--input"));
+
+    RenderSettings settings;
+    settings.outputDirectory = cwd.getChildFile(args.getValueForOption("--output"));
+    settings.blockSize = juce::jmax(64, args.containsOption("--block-size") ? args.getValueForOption("--block-size").getIntValue() : 8192);
+
+    if( ! inputDirectory.isDirectory() )
+    {
+        std::cerr << "input directory not found: " << inputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    //outputs take the names of their inputs, in the same directory they'd replace the sources
+    if( settings.outputDirectory == inputDirectory )
+    {
+        std::cerr << "output directory must differ from the input directory" << std::endl;
+        return 1;
+    }
+
+    if( ! settings.outputDirectory.createDirectory() )
+    {
+        std::cerr << "can't create output directory: " << settings.outputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    if( args.containsOption("--preset") )
+    {
+        auto presetFile = cwd.getChildFile(args.getValueForOption("--preset"));
+        if( ! presetFile.loadFileAsData(settings.preset) )
+        {
+            std::cerr << "can't read preset: " << presetFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    auto files = inputDirectory.findChildFiles(juce::File::findFiles, false, "*.wav;*.aif;*.aiff");
+    files.sort();
+
+    auto numThreads = args.containsOption("--threads") ? args.getValueForOption("--threads").getIntValue()
+                                                       : juce::SystemStats::getNumCpus();
+    numThreads = juce::jlimit(1, juce::jmax(1, files.size()), numThreads);
+
+    std::cout << "rendering " << files.size() << " files on " << numThreads << " threads" << std::endl;
+
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    std::atomic<int> nextFile {0};
+    std::vector<std::unique_ptr<RenderWorker>> workers;
+
+    for( int i = 0; i < numThreads; ++i )
+        workers.push_back(std::make_unique<RenderWorker>(i, settings, files, nextFile, formats));
+
+    for( auto& worker : workers )
+        worker->startThread();
+
+    int numFailures = 0;
+    double audioSeconds = 0.0;
+
+    for( auto& worker : workers )
+    {
+        worker->waitForThreadToExit(-1);
+        numFailures += worker->getNumFailures();
+        audioSeconds += worker->getAudioSecondsRendered();
+    }
+
+    auto wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+    std::cout << "done: " << audioSeconds << " s of audio in " << wallSeconds << " s, realtime x"
+              << audioSeconds / juce::jmax(wallSeconds, 1.0e-9) << " across all workers, "
+              << numFailures << " failed" << std::endl;
+
+    return numFailures == 0 ? 0 : 1;
+}
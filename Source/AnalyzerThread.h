@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    AnalyzerThread.h
+    One background thread, shared by every open SimpleEQ editor in the
+    process, that runs the spectrum analyzers off the message thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ hold it through a juce::SharedResourcePointer<AnalyzerThread>: the first editor to open starts the thread,
+ the last one to close stops it. each analyzer registers itself as a TimeSliceClient and the thread
+ takes turns between them, so a session full of editors still costs one thread.
+ */
+class AnalyzerThread : public juce::TimeSliceThread
+{
+public:
+    AnalyzerThread() : juce::TimeSliceThread("SimpleEQ analyzer")
+    {
+        startThread(3); //below normal, the GUI and audio threads come first
+    }
+
+    ~AnalyzerThread() override
+    {
+        stopThread(2000);
+    }
+
+    //how often each analyzer is asked for new work, a little faster than the 60 Hz repaint so a frame is always ready
+    static constexpr int serviceIntervalMs = 10;
+
+    JUCE_DECLARE_NON_COPYABLE (AnalyzerThread)
+};
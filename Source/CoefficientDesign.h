@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    CoefficientDesign.h
+    Allocation-free versions of the juce::dsp coefficient factories used by
+    the EQ, so coefficients can be redesigned on the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+/**
+ one biquad section normalised so a0 == 1.
+ same order as the raw coefficients of juce::dsp::IIR::Coefficients (b0, b1, b2, a1, a2)
+ */
+template<typename NumericType>
+struct BiquadCoefficients
+{
+    NumericType b0 {1}, b1 {0}, b2 {0}, a1 {0}, a2 {0};
+};
+
+//Slope_96 -> order 16 -> 8 biquad sections
+static constexpr int maxCutSections = 8;
+
+/**
+ preallocated replacement for the ReferenceCountedArray returned by
+ FilterDesign::designIIR...HighOrderButterworthMethod
+ */
+template<typename NumericType>
+struct CutCoefficients
+{
+    //indexed the same way as the ReferenceCountedArray so updateLowCutFilter/updateHighCutFilter accept either
+    const BiquadCoefficients<NumericType>& operator[](int index) const { return sections[(size_t) index]; }
+
+    std::array<BiquadCoefficients<NumericType>, maxCutSections> sections;
+    int numSections = 0;
+};
+
+namespace CoefficientDesign
+{
+    template<typename NumericType>
+    BiquadCoefficients<NumericType> normalise(double b0, double b1, double b2,
+                                              double a0, double a1, double a2)
+    {
+        const auto a0Inv = 1.0 / a0;
+
+        return { NumericType(b0 * a0Inv), NumericType(b1 * a0Inv), NumericType(b2 * a0Inv),
+                 NumericType(a1 * a0Inv), NumericType(a2 * a0Inv) };
+    }
+
+    //sinOmega/cosOmega of omega = 2 pi f / fs, split out so CoefficientTable can supply them from a lookup
+    template<typename NumericType>
+    void makePeakFromTrig(BiquadCoefficients<NumericType>& out, double sinOmega, double cosOmega, double Q, double gainFactor)
+    {
+        auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+        auto alpha = sinOmega / (Q * 2.0);
+        auto c2 = -2.0 * cosOmega;
+        auto alphaTimesA = alpha * A;
+        auto alphaOverA = alpha / A;
+
+        out = normalise<NumericType>(1.0 + alphaTimesA, c2, 1.0 - alphaTimesA,
+                                     1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+    }
+
+    //same maths as juce::dsp::IIR::Coefficients::makePeakFilter
+    template<typename NumericType>
+    void makePeak(BiquadCoefficients<NumericType>& out, double sampleRate, double frequency, double Q, double gainFactor)
+    {
+        auto omega = (juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0)) / sampleRate;
+        makePeakFromTrig(out, std::sin(omega), std::cos(omega), Q, gainFactor);
+    }
+
+    //Q of section 'index' of an even order butterworth (see FilterDesign::designIIRLowpassHighOrderButterworthMethod)
+    inline double butterworthQ(int index, int order)
+    {
+        return 1.0 / (2.0 * std::cos((2.0 * index + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)));
+    }
+
+    //tanValue = tan(pi * frequency / sampleRate), same maths as IIR::Coefficients::makeHighPass
+    template<typename NumericType>
+    void makeHighPass(BiquadCoefficients<NumericType>& out, double tanValue, double Q)
+    {
+        auto n = tanValue;
+        auto nSquared = n * n;
+        auto invQ = 1.0 / Q;
+        auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        out = { NumericType(c1), NumericType(c1 * -2.0), NumericType(c1),
+                NumericType(c1 * 2.0 * (nSquared - 1.0)), NumericType(c1 * (1.0 - invQ * n + nSquared)) };
+    }
+
+    //tanValue = tan(pi * frequency / sampleRate), same maths as IIR::Coefficients::makeLowPass
+    template<typename NumericType>
+    void makeLowPass(BiquadCoefficients<NumericType>& out, double tanValue, double Q)
+    {
+        auto n = 1.0 / tanValue;
+        auto nSquared = n * n;
+        auto invQ = 1.0 / Q;
+        auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        out = { NumericType(c1), NumericType(c1 * 2.0), NumericType(c1),
+                NumericType(c1 * 2.0 * (1.0 - nSquared)), NumericType(c1 * (1.0 - invQ * n + nSquared)) };
+    }
+
+    template<typename NumericType>
+    void makeButterworthHighPass(CutCoefficients<NumericType>& out, double frequency, double sampleRate, int order)
+    {
+        jassert(order > 0 && order % 2 == 0 && order / 2 <= maxCutSections);
+
+        auto tanValue = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+
+        out.numSections = order / 2;
+        for( int i = 0; i < out.numSections; ++i )
+            makeHighPass(out.sections[(size_t) i], tanValue, butterworthQ(i, order));
+    }
+
+    template<typename NumericType>
+    void makeButterworthLowPass(CutCoefficients<NumericType>& out, double frequency, double sampleRate, int order)
+    {
+        jassert(order > 0 && order % 2 == 0 && order / 2 <= maxCutSections);
+
+        auto tanValue = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+
+        out.numSections = order / 2;
+        for( int i = 0; i < out.numSections; ++i )
+            makeLowPass(out.sections[(size_t) i], tanValue, butterworthQ(i, order));
+    }
+
+    //largest pole magnitude of z^2 + a1 z + a2: the section's ringing shrinks by at least that factor every sample
+    template<typename NumericType>
+    double getPoleRadius(const BiquadCoefficients<NumericType>& section)
+    {
+        const auto a1 = double(section.a1), a2 = double(section.a2);
+        const auto discriminant = a1 * a1 - 4.0 * a2;
+
+        //complex pair: |p|^2 is the product of the poles, a2
+        if( discriminant < 0.0 )
+            return std::sqrt(a2);
+
+        const auto root = std::sqrt(discriminant);
+        return 0.5 * juce::jmax(std::abs(-a1 + root), std::abs(-a1 - root));
+    }
+
+    //samples until the ringing of a full scale impulse is below 'threshold' (linear), infinite if the section doesn't decay
+    template<typename NumericType>
+    double getDecayInSamples(const BiquadCoefficients<NumericType>& section, double threshold)
+    {
+        const auto radius = getPoleRadius(section);
+        if( radius >= 1.0 )
+            return std::numeric_limits<double>::infinity();
+
+        //FIR sections (both poles at 0) are done after their two samples of state
+        return radius > 0.0 ? std::log(threshold) / std::log(radius) : 2.0;
+    }
+
+    //the sections' decay times added up. the real ring out of a cascade is shorter, this errs on the long side
+    template<typename NumericType>
+    double getDecayInSamples(const CutCoefficients<NumericType>& cut, double threshold)
+    {
+        double total = 0.0;
+        for( int i = 0; i < cut.numSections; ++i )
+            total += getDecayInSamples(cut.sections[(size_t) i], threshold);
+
+        return total;
+    }
+
+    /**
+     writes a biquad straight into an existing IIR::Coefficients object.
+     the destination must already hold a biquad (5 raw coefficients) or this would have to reallocate.
+     */
+    template<typename NumericType>
+    void copyInto(juce::dsp::IIR::Coefficients<NumericType>& dest, const BiquadCoefficients<NumericType>& src)
+    {
+        jassert(dest.coefficients.size() == 5);
+
+        auto* raw = dest.getRawCoefficients();
+        raw[0] = src.b0;
+        raw[1] = src.b1;
+        raw[2] = src.b2;
+        raw[3] = src.a1;
+        raw[4] = src.a2;
+    }
+}
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    CoefficientTables.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientTables.h"
+
+CoefficientTable::CoefficientTable(double rate) : sampleRate(rate)
+{
+    jassert(sampleRate > 0);
+
+    entries.resize(numFrequencies);
+
+    for( int i = 0; i < numFrequencies; ++i )
+    {
+        auto frequency = double(minFrequency + i);
+        auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+
+        auto& entry = entries[(size_t) i];
+        entry.tanValue = float(std::tan(juce::MathConstants<double>::pi * frequency / sampleRate));
+        entry.sinOmega = float(std::sin(omega));
+        entry.oneMinusCos = float(2.0 * std::pow(std::sin(omega * 0.5), 2.0));
+    }
+
+    for( int numSections = 1; numSections <= maxCutSections; ++numSections )
+    {
+        auto& qs = butterworthQs[(size_t) numSections - 1];
+        for( int i = 0; i < maxCutSections; ++i )
+            qs[(size_t) i] = i < numSections ? CoefficientDesign::butterworthQ(i, numSections * 2) : 0.0;
+    }
+}
+
+CoefficientTable::Entry CoefficientTable::getEntry(float frequency) const
+{
+    //parameters land on whole Hz, smoothed values don't. rounding those would step 1/14 octave at 20 Hz, so interpolate
+    const auto position = juce::jlimit(0.f, float(numFrequencies - 1), frequency - float(minFrequency));
+    const auto index = juce::jmin((int) position, numFrequencies - 2);
+    const auto fraction = position - float(index);
+
+    const auto& lower = entries[(size_t) index];
+    const auto& upper = entries[(size_t) index + 1];
+
+    return { lower.tanValue + fraction * (upper.tanValue - lower.tanValue),
+             lower.sinOmega + fraction * (upper.sinOmega - lower.sinOmega),
+             lower.oneMinusCos + fraction * (upper.oneMinusCos - lower.oneMinusCos) };
+}
+
+template<typename NumericType>
+void CoefficientTable::designPeak(BiquadCoefficients<NumericType>& out, float frequency, float Q, float gainFactor) const
+{
+    const auto entry = getEntry(frequency);
+    CoefficientDesign::makePeakFromTrig(out, entry.sinOmega, 1.0 - double(entry.oneMinusCos), Q, gainFactor);
+}
+
+template<typename NumericType>
+void CoefficientTable::designButterworthHighPass(CutCoefficients<NumericType>& out, float frequency, int order) const
+{
+    jassert(order > 0 && order % 2 == 0 && order / 2 <= maxCutSections);
+
+    const auto entry = getEntry(frequency);
+    const auto& qs = butterworthQs[(size_t) order / 2 - 1];
+
+    out.numSections = order / 2;
+    for( int i = 0; i < out.numSections; ++i )
+        CoefficientDesign::makeHighPass(out.sections[(size_t) i], entry.tanValue, qs[(size_t) i]);
+}
+
+template<typename NumericType>
+void CoefficientTable::designButterworthLowPass(CutCoefficients<NumericType>& out, float frequency, int order) const
+{
+    jassert(order > 0 && order % 2 == 0 && order / 2 <= maxCutSections);
+
+    const auto entry = getEntry(frequency);
+    const auto& qs = butterworthQs[(size_t) order / 2 - 1];
+
+    out.numSections = order / 2;
+    for( int i = 0; i < out.numSections; ++i )
+        CoefficientDesign::makeLowPass(out.sections[(size_t) i], entry.tanValue, qs[(size_t) i]);
+}
+
+template void CoefficientTable::designPeak<float>(BiquadCoefficients<float>&, float, float, float) const;
+template void CoefficientTable::designPeak<double>(BiquadCoefficients<double>&, float, float, float) const;
+template void CoefficientTable::designButterworthHighPass<float>(CutCoefficients<float>&, float, int) const;
+template void CoefficientTable::designButterworthHighPass<double>(CutCoefficients<double>&, float, int) const;
+template void CoefficientTable::designButterworthLowPass<float>(CutCoefficients<float>&, float, int) const;
+template void CoefficientTable::designButterworthLowPass<double>(CutCoefficients<double>&, float, int) const;
+
+std::shared_ptr<const CoefficientTable> CoefficientTable::getForSampleRate(double sampleRate)
+{
+    //weak references so a table goes away once the last instance at that rate lets go of it
+    static juce::CriticalSection lock;
+    static std::map<double, std::weak_ptr<const CoefficientTable>> tables;
+
+    const juce::ScopedLock sl(lock);
+
+    //rates nobody runs at any more, or the map would keep one dead entry per rate ever used
+    for( auto it = tables.begin(); it != tables.end(); )
+        it = it->second.expired() ? tables.erase(it) : std::next(it);
+
+    auto& slot = tables[sampleRate];
+    if( auto existing = slot.lock() )
+        return existing;
+
+    auto table = std::make_shared<const CoefficientTable>(sampleRate);
+    slot = table;
+    return table;
+}
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    CoefficientTables.h
+    Optional lookup tables that replace the trig in the coefficient designs
+    with a table lookup, built once per sample rate and shared by every
+    instance running at that rate.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesign.h"
+
+/**
+ the "Freq" parameters are NormalisableRange<float>(20, 20000, 1, 0.25) so they can only land on whole Hz.
+ storing finished coefficient sets for every cutoff and slope would take ~8 MB per rate, so the table keeps the
+ only expensive part of each design instead (tan(pi f / fs) for the cut filters, sin/cos(2 pi f / fs) for the peak),
+ 3 floats per frequency (~240 KB), and finishes the sections with a handful of multiplies. smoothed frequencies fall
+ between whole Hz and are interpolated from the two neighbouring entries.
+ */
+class CoefficientTable
+{
+public:
+    static constexpr int minFrequency = 20;
+    static constexpr int maxFrequency = 20000;
+    static constexpr int numFrequencies = maxFrequency - minFrequency + 1;
+
+    explicit CoefficientTable(double sampleRate);
+
+    double getSampleRate() const { return sampleRate; }
+
+    //float and double outputs, the double ones are finished in double but start from the same float trig values
+    template<typename NumericType>
+    void designPeak(BiquadCoefficients<NumericType>& out, float frequency, float Q, float gainFactor) const;
+    template<typename NumericType>
+    void designButterworthHighPass(CutCoefficients<NumericType>& out, float frequency, int order) const;
+    template<typename NumericType>
+    void designButterworthLowPass(CutCoefficients<NumericType>& out, float frequency, int order) const;
+
+    /**
+     returns the table for this sample rate, building it if no other instance holds one.
+     allocates and may block, only call it from prepareToPlay or the message thread.
+     */
+    static std::shared_ptr<const CoefficientTable> getForSampleRate(double sampleRate);
+
+private:
+    struct Entry
+    {
+        float tanValue;     // tan(pi f / fs)
+        float sinOmega;     // sin(2 pi f / fs)
+        float oneMinusCos;  // 1 - cos(2 pi f / fs), keeps the precision cos loses near 1 at low frequencies
+    };
+
+    Entry getEntry(float frequency) const; //linearly interpolated between the whole Hz entries
+
+    double sampleRate;
+    std::vector<Entry> entries;
+
+    //butterworthQs[order/2 - 1][section]
+    std::array<std::array<double, maxCutSections>, maxCutSections> butterworthQs;
+
+    JUCE_DECLARE_NON_COPYABLE (CoefficientTable)
+};
@@ -0,0 +1,167 @@
+/*
+  ==============================================================================
+
+    FastDecibels.h
+    Branch-free magnitude -> decibel conversion for the analyzer, one SIMD
+    pass instead of a sanitize loop followed by a gainToDecibels loop.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+/**
+ log2(x) = e + log2(m) with x = m * 2^e. m is folded into [sqrt(1/2), sqrt(2)) so u = m - 1 stays small, and log2(1 + u)
+ is a degree 6 polynomial fitted at the Chebyshev nodes of that range.
+
+ the polynomial is within 2.5e-6 of log2, i.e. 1.5e-5 dB. float rounding of e + log2(m) adds about 1e-7 of the
+ result, so measured against double precision 20 log10 over -140 .. +80 dB the error stays below 3e-5 dB,
+ far under a pixel.
+ */
+namespace FastDecibels
+{
+    constexpr float decibelsPerOctave = 6.02059991f; //20 log10(2)
+    constexpr float sqrtTwo = 1.41421356f;
+
+    constexpr float c0 = -1.69588841e-06f, c1 = 1.4427095f, c2 = -0.721020947f, c3 = 0.479587772f,
+                    c4 = -0.369369218f, c5 = 0.319914128f, c6 = -0.196548278f;
+
+    constexpr juce::uint32 exponentMask = 0x7f800000u, mantissaMask = 0x007fffffu, one = 0x3f800000u;
+
+    /** one bin of convertMagnitudesToDecibels, used for the tail and where there are no intrinsics. */
+    inline float convert(float magnitude, float scale, float negativeInfinity) noexcept
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, &magnitude, sizeof(bits));
+
+        //NaN and inf have every exponent bit set
+        if( (bits & exponentMask) == exponentMask || ! (magnitude > 0.f) )
+            return negativeInfinity;
+
+        magnitude *= scale;
+        std::memcpy(&bits, &magnitude, sizeof(bits));
+
+        auto exponent = (int) (bits >> 23) - 127;
+        auto mantissaBits = (bits & mantissaMask) | one;
+        float m;
+        std::memcpy(&m, &mantissaBits, sizeof(m));
+
+        if( m > sqrtTwo )
+        {
+            m *= 0.5f;
+            ++exponent;
+        }
+
+        const auto u = m - 1.f;
+        const auto log2m = c0 + u * (c1 + u * (c2 + u * (c3 + u * (c4 + u * (c5 + u * c6)))));
+
+        return juce::jmax(negativeInfinity, decibelsPerOctave * ((float) exponent + log2m));
+    }
+}
+
+/**
+ normalizes the magnitudes of an FFT of 2 * numBins samples and converts them to decibels, in place.
+ NaN/inf bins come out as 'negativeInfinity', the same as gainToDecibels(0) does, and so does anything at or
+ below it. see FastDecibels for the error bound.
+ */
+inline void convertMagnitudesToDecibels(float* fftData, int numBins, const float negativeInfinity)
+{
+    using namespace FastDecibels;
+
+    const auto scale = 1.f / float(numBins);
+    int i = 0;
+
+   #if JUCE_USE_SSE_INTRINSICS
+    const auto exponentMaskV = _mm_set1_epi32((int) exponentMask);
+    const auto mantissaMaskV = _mm_set1_epi32((int) mantissaMask);
+    const auto oneV = _mm_set1_epi32((int) one);
+    const auto bias = _mm_set1_epi32(127);
+    const auto scaleV = _mm_set1_ps(scale);
+    const auto floorV = _mm_set1_ps(negativeInfinity);
+    const auto sqrtTwoV = _mm_set1_ps(sqrtTwo);
+
+    for( ; i + 4 <= numBins; i += 4 )
+    {
+        auto v = _mm_loadu_ps(fftData + i);
+
+        //bins that are NaN/inf or not positive end up at the floor
+        const auto nonFinite = _mm_cmpeq_epi32(_mm_and_si128(_mm_castps_si128(v), exponentMaskV), exponentMaskV);
+        const auto valid = _mm_andnot_ps(_mm_castsi128_ps(nonFinite), _mm_cmpgt_ps(v, _mm_setzero_ps()));
+
+        v = _mm_mul_ps(v, scaleV);
+        const auto bits = _mm_castps_si128(v);
+
+        auto exponent = _mm_sub_epi32(_mm_srli_epi32(bits, 23), bias);
+        auto m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mantissaMaskV), oneV));
+
+        const auto high = _mm_cmpgt_ps(m, sqrtTwoV);
+        m = _mm_or_ps(_mm_and_ps(high, _mm_mul_ps(m, _mm_set1_ps(0.5f))), _mm_andnot_ps(high, m));
+        exponent = _mm_sub_epi32(exponent, _mm_castps_si128(high)); //the mask is -1 where it's set
+
+        const auto u = _mm_sub_ps(m, _mm_set1_ps(1.f));
+        auto p = _mm_set1_ps(c6);
+        p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(c5));
+        p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(c4));
+        p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(c3));
+        p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(c2));
+        p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(c1));
+        p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(c0));
+
+        auto db = _mm_mul_ps(_mm_add_ps(_mm_cvtepi32_ps(exponent), p), _mm_set1_ps(decibelsPerOctave));
+        db = _mm_max_ps(db, floorV);
+        db = _mm_or_ps(_mm_and_ps(valid, db), _mm_andnot_ps(valid, floorV));
+
+        _mm_storeu_ps(fftData + i, db);
+    }
+   #elif JUCE_USE_ARM_NEON
+    const auto exponentMaskV = vdupq_n_u32(exponentMask);
+    const auto mantissaMaskV = vdupq_n_u32(mantissaMask);
+    const auto oneV = vdupq_n_u32(one);
+    const auto bias = vdupq_n_s32(127);
+    const auto floorV = vdupq_n_f32(negativeInfinity);
+    const auto sqrtTwoV = vdupq_n_f32(sqrtTwo);
+
+    for( ; i + 4 <= numBins; i += 4 )
+    {
+        auto v = vld1q_f32(fftData + i);
+
+        const auto nonFinite = vceqq_u32(vandq_u32(vreinterpretq_u32_f32(v), exponentMaskV), exponentMaskV);
+        const auto valid = vbicq_u32(vcgtq_f32(v, vdupq_n_f32(0.f)), nonFinite);
+
+        v = vmulq_n_f32(v, scale);
+        const auto bits = vreinterpretq_u32_f32(v);
+
+        auto exponent = vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), bias);
+        auto m = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, mantissaMaskV), oneV));
+
+        const auto high = vcgtq_f32(m, sqrtTwoV);
+        m = vbslq_f32(high, vmulq_n_f32(m, 0.5f), m);
+        exponent = vsubq_s32(exponent, vreinterpretq_s32_u32(high));
+
+        const auto u = vsubq_f32(m, vdupq_n_f32(1.f));
+        auto p = vdupq_n_f32(c6);
+        p = vmlaq_f32(vdupq_n_f32(c5), p, u);
+        p = vmlaq_f32(vdupq_n_f32(c4), p, u);
+        p = vmlaq_f32(vdupq_n_f32(c3), p, u);
+        p = vmlaq_f32(vdupq_n_f32(c2), p, u);
+        p = vmlaq_f32(vdupq_n_f32(c1), p, u);
+        p = vmlaq_f32(vdupq_n_f32(c0), p, u);
+
+        auto db = vmulq_n_f32(vaddq_f32(vcvtq_f32_s32(exponent), p), decibelsPerOctave);
+        db = vbslq_f32(valid, vmaxq_f32(db, floorV), floorV);
+
+        vst1q_f32(fftData + i, db);
+    }
+   #endif
+
+    for( ; i < numBins; ++i )
+        fftData[i] = convert(fftData[i], scale, negativeInfinity);
+}
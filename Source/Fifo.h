@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    Fifo.h
+    Lock-free single producer / single consumer queue of preallocated
+    objects, shared by the analyzer and the linear phase kernel handoff.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//READ ABOUT FIFO AND ALGORITHM TO GENERATE SPECTRUM STUFF
+#include <array>
+/**
+ single producer / single consumer queue of preallocated T's.
+
+ push/pull copy, exchangePush/exchangePull swap the caller's object with a slot so ownership of the
+ preallocated storage just moves back and forth, and peekWrite/peekRead + commitWrite/commitRead let the
+ caller fill or use a slot in place. AbstractFifo keeps one slot free, so Capacity - 1 items fit.
+ */
+template<typename T, int Capacity = 30>
+struct Fifo
+{
+    static_assert( Capacity >= 2, "the fifo needs at least one usable slot" );
+    
+    void prepare(int numChannels, int numSamples)
+    {
+        static_assert( std::is_same_v<T, juce::AudioBuffer<float>>,
+                      "prepare(numChannels, numSamples) should only be used when the Fifo is holding juce::AudioBuffer<float>");
+        for( auto& buffer : buffers)
+        {
+            buffer.setSize(numChannels,
+                           numSamples,
+                           false,   //clear everything?
+                           true,    //including the extra space?
+                           true);   //avoid reallocating if you can?
+            buffer.clear();
+        }
+    }
+    
+    void prepare(size_t numElements)
+    {
+        static_assert( std::is_same_v<T, std::vector<float>>,
+                      "prepare(numElements) should only be used when the Fifo is holding std::vector<float>");
+        for( auto& buffer : buffers )
+        {
+            buffer.clear();
+            buffer.resize(numElements, 0);
+        }
+    }
+    
+    bool push(const T& t)
+    {
+        if( auto* slot = peekWrite() )
+        {
+            *slot = t;
+            commitWrite();
+            return true;
+        }
+        
+        return false;
+    }
+    
+    bool pull(T& t)
+    {
+        if( auto* slot = peekRead() )
+        {
+            t = *slot;
+            commitRead();
+            return true;
+        }
+        
+        return false;
+    }
+    
+    //'t' goes into the fifo and comes back holding the slot's old (preallocated) storage
+    bool exchangePush(T& t)
+    {
+        if( auto* slot = peekWrite() )
+        {
+            std::swap(*slot, t);
+            commitWrite();
+            return true;
+        }
+        
+        return false;
+    }
+    
+    //the oldest item is swapped into 't', t's old storage stays in the fifo to be reused
+    bool exchangePull(T& t)
+    {
+        if( auto* slot = peekRead() )
+        {
+            std::swap(*slot, t);
+            commitRead();
+            return true;
+        }
+        
+        return false;
+    }
+    
+    //the next slot to write, or nullptr if the fifo is full. nothing is published until commitWrite()
+    T* peekWrite()
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        return size1 > 0 ? &buffers[(size_t) start1] : nullptr;
+    }
+    
+    void commitWrite() { fifo.finishedWrite(1); }
+    
+    //the oldest item, or nullptr if the fifo is empty. it stays in the fifo until commitRead()
+    T* peekRead()
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(1, start1, size1, start2, size2);
+        return size1 > 0 ? &buffers[(size_t) start1] : nullptr;
+    }
+    
+    void commitRead() { fifo.finishedRead(1); }
+    
+    int getNumAvailableForReading() const
+    {
+        return fifo.getNumReady();
+    }
+    
+    int getFreeSpace() const
+    {
+        return fifo.getFreeSpace();
+    }
+private:
+    std::array<T, Capacity> buffers;
+    juce::AbstractFifo fifo {Capacity};
+};
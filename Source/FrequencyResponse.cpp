@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    FrequencyResponse.cpp
+
+  ==============================================================================
+*/
+
+#include "FrequencyResponse.h"
+
+namespace
+{
+    bool sameSection(const BiquadCoefficients<float>& a, const BiquadCoefficients<float>& b)
+    {
+        return a.b0 == b.b0 && a.b1 == b.b1 && a.b2 == b.b2 && a.a1 == b.a1 && a.a2 == b.a2;
+    }
+}
+
+void FrequencyResponse::setFrequencies(const double* frequencies, int newNumFrequencies, double sampleRate)
+{
+    jassert(sampleRate > 0.0);
+
+    numFrequencies = newNumFrequencies;
+    const auto size = (size_t) numFrequencies;
+
+    cos1.resize(size);
+    sin1.resize(size);
+    cos2.resize(size);
+    sin2.resize(size);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        auto w = juce::MathConstants<double>::twoPi * frequencies[i] / sampleRate;
+        cos1[i] = std::cos(w);
+        sin1[i] = std::sin(w);
+        cos2[i] = std::cos(2.0 * w);
+        sin2[i] = std::sin(2.0 * w);
+    }
+
+    for (auto& magnitudes : sectionMagnitudesSquared)
+        magnitudes.resize(size);
+
+    total.resize(size);
+    decibels.resize(size);
+    allDirty = true;
+}
+
+bool FrequencyResponse::update(const CascadeCoefficients<float>& coefficients)
+{
+    bool changed = allDirty;
+
+    for (int slot = 0; slot < numSlots; ++slot)
+    {
+        const auto active = coefficients.isSlotActive(slot);
+        const auto& section = coefficients.getSlot(slot);
+
+        if (active && (allDirty || ! evaluatedActive[(size_t) slot] || ! sameSection(section, evaluatedSections[(size_t) slot])))
+        {
+            evaluateSection(slot, section);
+            evaluatedSections[(size_t) slot] = section;
+            changed = true;
+        }
+
+        changed = changed || active != evaluatedActive[(size_t) slot];
+        evaluatedActive[(size_t) slot] = active;
+    }
+
+    allDirty = false;
+
+    if (! changed)
+        return false;
+
+    std::fill(total.begin(), total.end(), 1.0);
+
+    for (int slot = 0; slot < numSlots; ++slot)
+        if (evaluatedActive[(size_t) slot])
+            juce::FloatVectorOperations::multiply(total.data(), sectionMagnitudesSquared[(size_t) slot].data(), numFrequencies);
+
+    //|H|^2 -> dB, 10 log10 instead of 20 log10 |H| saves the square roots. floored like Decibels::gainToDecibels
+    for (int i = 0; i < numFrequencies; ++i)
+        decibels[(size_t) i] = total[(size_t) i] > 1.0e-10 ? 10.0 * std::log10(total[(size_t) i]) : -100.0;
+
+    return true;
+}
+
+void FrequencyResponse::evaluateSection(int slot, const Slot& section)
+{
+    const double b0 = section.b0, b1 = section.b1, b2 = section.b2;
+    const double a1 = section.a1, a2 = section.a2;
+
+    auto* out = sectionMagnitudesSquared[(size_t) slot].data();
+    const auto* c1 = cos1.data();
+    const auto* s1 = sin1.data();
+    const auto* c2 = cos2.data();
+    const auto* s2 = sin2.data();
+
+    //H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2) at z^-k = cos kw - j sin kw.
+    //the sign of the imaginary parts doesn't change the magnitude, so it's dropped
+    for (int i = 0; i < numFrequencies; ++i)
+    {
+        auto numeratorRe = b0 + b1 * c1[i] + b2 * c2[i];
+        auto numeratorIm = b1 * s1[i] + b2 * s2[i];
+        auto denominatorRe = 1.0 + a1 * c1[i] + a2 * c2[i];
+        auto denominatorIm = a1 * s1[i] + a2 * s2[i];
+
+        out[i] = (numeratorRe * numeratorRe + numeratorIm * numeratorIm)
+               / (denominatorRe * denominatorRe + denominatorIm * denominatorIm);
+    }
+}
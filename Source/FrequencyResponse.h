@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    FrequencyResponse.h
+    Magnitude response of the EQ cascade at a fixed set of frequencies,
+    cached per section so only the sections that changed are re-evaluated.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FusedCascade.h"
+
+/**
+ evaluates |H(e^jw)| of every active section of a CascadeCoefficients set at the frequencies given to setFrequencies().
+
+ e^-jw and e^-2jw are tabulated once per frequency set, so a section costs a handful of multiply-adds per frequency
+ (no complex arithmetic, no trig), laid out as plain arrays the compiler vectorizes. each section's |H|^2 is kept,
+ so update() only re-evaluates the sections whose coefficients actually moved before multiplying them together.
+ */
+class FrequencyResponse
+{
+public:
+    /** rebuilds the tables, everything is re-evaluated on the next update(). allocates. */
+    void setFrequencies(const double* frequencies, int numFrequencies, double sampleRate);
+
+    /** re-evaluates the sections that changed since the last call, returns true if the response moved. */
+    bool update(const CascadeCoefficients<float>& coefficients);
+
+    int getNumFrequencies() const { return numFrequencies; }
+
+    /** the response in dB at each frequency, floored at juce::Decibels' default -100 dB like gainToDecibels. */
+    const double* getMagnitudesInDecibels() const { return decibels.data(); }
+
+    /** |H|^2 at each frequency, unfloored. */
+    const double* getMagnitudesSquared() const { return total.data(); }
+
+private:
+    using Slot = BiquadCoefficients<float>;
+    static constexpr int numSlots = CascadeCoefficients<float>::numSlots;
+
+    int numFrequencies = 0;
+
+    //cos w, sin w, cos 2w, sin 2w per frequency
+    std::vector<double> cos1, sin1, cos2, sin2;
+
+    std::array<std::vector<double>, numSlots> sectionMagnitudesSquared;
+    std::array<Slot, numSlots> evaluatedSections;
+    std::array<bool, numSlots> evaluatedActive {};
+    bool allDirty = true;
+
+    std::vector<double> total, decibels;
+
+    void evaluateSection(int slot, const Slot& section);
+};
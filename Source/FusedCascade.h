@@ -0,0 +1,233 @@
+/*
+  ==============================================================================
+
+    FusedCascade.h
+    Runs every active biquad of the EQ per sample in a single sweep over the
+    block, instead of one full-buffer pass per section like ProcessorChain.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesign.h"
+
+/**
+ the coefficient set of the whole EQ cascade (maxCutSections low cut sections, the peak, maxCutSections high cut sections) plus
+ which of them are active.
+ kept apart from FusedBiquadCascade so every channel of a bus can share one set.
+ */
+template<typename NumericType>
+class CascadeCoefficients
+{
+public:
+    //slot layout matches MonoChain: LowCut 0..maxCutSections-1, Peak, HighCut 0..maxCutSections-1
+    static constexpr int peakSlot = maxCutSections;
+    static constexpr int numSlots = 2 * maxCutSections + 1;
+
+    //bands in ChainPositions order
+    static constexpr int lowCutBand = 0, peakBand = 1, highCutBand = 2, numBands = 3;
+
+    static constexpr int getFirstSlot(int band)    { return band == lowCutBand ? 0 : (band == peakBand ? peakSlot : peakSlot + 1); }
+    static constexpr int getNumBandSlots(int band) { return band == peakBand ? 1 : maxCutSections; }
+    static constexpr int getBand(int slot)         { return slot < peakSlot ? lowCutBand : (slot == peakSlot ? peakBand : highCutBand); }
+
+    void setLowCut(const CutCoefficients<NumericType>& lowCut)   { setCut(lowCutBand, lowCut); }
+    void setHighCut(const CutCoefficients<NumericType>& highCut) { setCut(highCutBand, highCut); }
+
+    void setPeak(const BiquadCoefficients<NumericType>& peak)
+    {
+        designed[peakSlot] = peak;
+        active[peakSlot] = true;
+        updateBand(peakBand);
+    }
+
+    /**
+     how much of a band is in the cascade: 1 is the band as designed, 0 takes its sections out of the sweep entirely.
+     in between every section of the band is blended towards a pass-through (b = mix * b + (1 - mix) * a), for each
+     section that is exactly mix * section + (1 - mix) * input, so ramping the mix fades the band in or out without a jump.
+     */
+    void setBandMix(int band, NumericType mix)
+    {
+        bandMix[(size_t) band] = juce::jlimit(NumericType(0), NumericType(1), mix);
+        updateBand(band);
+    }
+
+    NumericType getBandMix(int band) const { return bandMix[(size_t) band]; }
+
+    int getNumActiveSections() const { return numActive; }
+    bool isSlotActive(int slot) const { return active[(size_t) slot] && bandMix[(size_t) getBand(slot)] > NumericType(0); }
+    int getActiveSlot(int index) const { return activeSlots[(size_t) index]; }
+    const BiquadCoefficients<NumericType>& getSlot(int slot) const { return coefficients[(size_t) slot]; }
+
+private:
+    std::array<BiquadCoefficients<NumericType>, numSlots> designed, coefficients; //as set, and after the band mix
+    std::array<bool, numSlots> active {};
+    std::array<NumericType, numBands> bandMix { NumericType(1), NumericType(1), NumericType(1) };
+
+    std::array<int, numSlots> activeSlots {};
+    int numActive = 0;
+
+    void setCut(int band, const CutCoefficients<NumericType>& cut)
+    {
+        //inactive sections keep their state, same as a bypassed Filter in the ProcessorChain
+        for( int i = 0; i < maxCutSections; ++i )
+        {
+            auto slot = (size_t) (getFirstSlot(band) + i);
+            active[slot] = i < cut.numSections;
+            if( active[slot] )
+                designed[slot] = cut.sections[(size_t) i];
+        }
+
+        updateBand(band);
+    }
+
+    void updateBand(int band)
+    {
+        const auto mix = bandMix[(size_t) band];
+
+        for( int slot = getFirstSlot(band); slot < getFirstSlot(band) + getNumBandSlots(band); ++slot )
+        {
+            const auto& d = designed[(size_t) slot];
+            auto& c = coefficients[(size_t) slot];
+
+            if( mix >= NumericType(1) )
+            {
+                c = d;
+                continue;
+            }
+
+            c.a1 = d.a1;
+            c.a2 = d.a2;
+            c.b0 = mix * d.b0 + (NumericType(1) - mix);
+            c.b1 = mix * d.b1 + (NumericType(1) - mix) * d.a1;
+            c.b2 = mix * d.b2 + (NumericType(1) - mix) * d.a2;
+        }
+
+        updateActiveSlots();
+    }
+
+    void updateActiveSlots()
+    {
+        numActive = 0;
+        for( int slot = 0; slot < numSlots; ++slot )
+            if( isSlotActive(slot) )
+                activeSlots[(size_t) numActive++] = slot;
+    }
+};
+
+/**
+ drop-in for the MonoChain cascade.
+
+ uses the same transposed direct form II update, in the same order, as juce::dsp::IIR::Filter
+ so the output matches the ProcessorChain version, but each sample goes through every active
+ section before the next one is read, so the block is only swept once.
+
+ the sweep is compiled once per number of active sections (processSections<N>, N = 0 .. numSlots), so the section loop
+ has a constant trip count and is fully unrolled, and inactive sections aren't in the code at all. the kernel is picked
+ from a table when the number of active sections changes, i.e. on a slope change or a cut being switched on or off.
+
+ SampleType can be float, double or a juce::dsp::SIMDRegister, the coefficients are always NumericType.
+ only the filter state lives here, the coefficients are passed in so channels can share them.
+ */
+template<typename SampleType>
+class FusedBiquadCascade
+{
+public:
+    using NumericType = typename juce::dsp::SampleTypeHelpers::ElementType<SampleType>::Type;
+    using Coefficients = CascadeCoefficients<NumericType>;
+
+    FusedBiquadCascade() { reset(); }
+
+    void reset()
+    {
+        for( auto& state : states )
+            state = { SampleType {0}, SampleType {0} };
+    }
+
+    //clears the state of some slots only, e.g. a band coming back into the cascade
+    void resetSlots(int firstSlot, int numSlotsToReset)
+    {
+        for( int slot = firstSlot; slot < firstSlot + numSlotsToReset; ++slot )
+            states[(size_t) slot] = { SampleType {0}, SampleType {0} };
+    }
+
+    void process(const Coefficients& coefficients, SampleType* data, size_t numSamples) noexcept
+    {
+        const auto numActive = coefficients.getNumActiveSections();
+
+        if( numActive != kernelSections )
+        {
+            kernel = getKernel(numActive);
+            kernelSections = numActive;
+        }
+
+        kernel(coefficients, states, data, numSamples);
+    }
+
+private:
+    struct State
+    {
+        SampleType s1, s2;
+    };
+
+    using States = std::array<State, Coefficients::numSlots>;
+    using Kernel = void (*)(const Coefficients&, States&, SampleType*, size_t);
+
+    States states;
+    Kernel kernel = &processSections<0>;
+    int kernelSections = 0;
+
+    template<int NumSections>
+    static void processSections(const Coefficients& coefficients, States& states, SampleType* data, size_t numSamples) noexcept
+    {
+        //pull the active sections into locals so the compiler can keep them in registers for the whole sweep
+        std::array<BiquadCoefficients<NumericType>, NumSections> c;
+        std::array<SampleType, NumSections> s1, s2;
+
+        for( int k = 0; k < NumSections; ++k )
+        {
+            auto slot = coefficients.getActiveSlot(k);
+            c[(size_t) k] = coefficients.getSlot(slot);
+            s1[(size_t) k] = states[(size_t) slot].s1;
+            s2[(size_t) k] = states[(size_t) slot].s2;
+        }
+
+        for( size_t i = 0; i < numSamples; ++i )
+        {
+            auto x = data[i];
+
+            for( size_t k = 0; k < (size_t) NumSections; ++k )
+            {
+                auto y = x * c[k].b0 + s1[k];
+                s1[k] = (x * c[k].b1) - (y * c[k].a1) + s2[k];
+                s2[k] = (x * c[k].b2) - (y * c[k].a2);
+                x = y;
+            }
+
+            data[i] = x;
+        }
+
+        for( int k = 0; k < NumSections; ++k )
+        {
+            auto& state = states[(size_t) coefficients.getActiveSlot(k)];
+            state.s1 = s1[(size_t) k];
+            state.s2 = s2[(size_t) k];
+            juce::dsp::util::snapToZero(state.s1);
+            juce::dsp::util::snapToZero(state.s2);
+        }
+    }
+
+    template<size_t... Counts>
+    static constexpr std::array<Kernel, sizeof...(Counts)> makeKernels(std::index_sequence<Counts...>)
+    {
+        return { &processSections<(int) Counts>... };
+    }
+
+    static Kernel getKernel(int numSections)
+    {
+        static constexpr auto kernels = makeKernels(std::make_index_sequence<Coefficients::numSlots + 1>());
+        return kernels[(size_t) juce::jlimit(0, Coefficients::numSlots, numSections)];
+    }
+};
@@ -0,0 +1,261 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEQ.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseEQ.h"
+
+namespace
+{
+    //partitions per kernel. the multiply-add cost per sample is 2 * numPartitions, the FFT cost shrinks as partitions grow
+    constexpr int numPartitionsPerKernel = 32;
+}
+
+void LinearPhaseDesigner::prepare(double sampleRate, int newKernelLength, int partitionSize)
+{
+    jassert(juce::isPowerOfTwo(newKernelLength));
+
+    kernelLength = newKernelLength;
+    const auto numBins = kernelLength / 2 + 1;
+
+    std::vector<double> frequencies((size_t) numBins);
+    for( int k = 0; k < numBins; ++k )
+        frequencies[(size_t) k] = k * sampleRate / kernelLength;
+
+    response.setFrequencies(frequencies.data(), numBins, sampleRate);
+
+    fft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(kernelLength)));
+    spectrum.assign((size_t) kernelLength, {});
+    impulse.assign((size_t) kernelLength, {});
+    taps.assign((size_t) kernelLength, 0.f);
+
+    //symmetric about kernelLength / 2, the one point past the end would pair with tap 0
+    window.resize((size_t) kernelLength + 1);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), window.size(),
+                                                             juce::dsp::WindowingFunction<float>::blackman, false);
+
+    partitioner.prepare(partitionSize);
+}
+
+void LinearPhaseDesigner::design(const CascadeCoefficients<float>& cascade, PartitionedKernel& kernel)
+{
+    response.update(cascade);
+    const auto* magnitudesSquared = response.getMagnitudesSquared();
+
+    //zero phase: a real, even spectrum gives a real impulse centred on sample 0
+    const auto half = kernelLength / 2;
+    for( int k = 0; k <= half; ++k )
+        spectrum[(size_t) k] = { (float) std::sqrt(magnitudesSquared[k]), 0.f };
+    for( int k = 1; k < half; ++k )
+        spectrum[(size_t) (kernelLength - k)] = spectrum[(size_t) k];
+
+    fft->perform(spectrum.data(), impulse.data(), true);
+
+    //rotate the centre to kernelLength / 2 and window off the time aliasing at the ends
+    for( int n = 0; n < kernelLength; ++n )
+        taps[(size_t) n] = impulse[(size_t) ((n + half) & (kernelLength - 1))].real() * window[(size_t) n];
+
+    partitioner.partition(taps.data(), kernelLength, kernel);
+}
+
+//==============================================================================
+LinearPhaseEQ::LinearPhaseEQ(CascadeSource source) :
+cascadeSource(std::move(source))
+{
+    designThread->addTimeSliceClient(this);
+}
+
+LinearPhaseEQ::~LinearPhaseEQ()
+{
+    //waits if the thread is designing for us right now
+    designThread->removeTimeSliceClient(this);
+
+    delete builtEngine.exchange(nullptr);
+}
+
+int LinearPhaseEQ::getKernelLength(double sampleRate)
+{
+    auto ratio = juce::jmax(1, juce::roundToInt(sampleRate / 48000.0));
+    return 16384 * juce::nextPowerOfTwo(ratio);
+}
+
+void LinearPhaseEQ::prepare(double newSampleRate, int newNumChannels)
+{
+    const juce::ScopedLock sl(designLock);
+
+    sampleRate = newSampleRate;
+    numChannels = newNumChannels;
+
+    kernelLength = getKernelLength(sampleRate);
+    partitionSize = kernelLength / numPartitionsPerKernel;
+    latency = kernelLength / 2 + partitionSize;
+
+    //whatever was built or designed for the old rate must never reach process()
+    engine.reset();
+    delete builtEngine.exchange(nullptr);
+
+    while( kernelFifo.peekRead() != nullptr )
+        kernelFifo.commitRead();
+
+    //the design thread builds afresh once the mode is enabled
+    ++preparedVersion;
+}
+
+bool LinearPhaseEQ::isReady()
+{
+    if( engine == nullptr )
+        engine.reset(builtEngine.exchange(nullptr));
+
+    return engine != nullptr;
+}
+
+void LinearPhaseEQ::buildNow()
+{
+    {
+        //waits if the design thread is building right now, then there's nothing left to do
+        const juce::ScopedLock sl(designLock);
+
+        if( builtVersion != preparedVersion && sampleRate > 0.0 )
+            buildEngine();
+    }
+
+    isReady();
+}
+
+void LinearPhaseEQ::reset()
+{
+    if( engine == nullptr )
+        return;
+
+    for( auto& convolver : engine->convolvers )
+        convolver.reset();
+
+    engine->position = 0;
+}
+
+void LinearPhaseEQ::setEnabled(bool shouldBeEnabled)
+{
+    //whatever changed while it was off is picked up with a fresh design
+    if( shouldBeEnabled && ! enabled.exchange(true) )
+        requestDesign();
+    else if( ! shouldBeEnabled )
+        enabled = false;
+}
+
+void LinearPhaseEQ::process(const juce::dsp::AudioBlock<float>& block)
+{
+    if( ! isReady() )
+        return;
+
+    auto& convolvers = engine->convolvers;
+    auto& position = engine->position;
+
+    const auto channelsToProcess = juce::jmin((int) block.getNumChannels(), numChannels);
+    const auto numSamples = (int) block.getNumSamples();
+
+    for( int start = 0; start < numSamples; )
+    {
+        //up to the next partition boundary
+        const auto chunk = juce::jmin(numSamples - start, partitionSize - position);
+
+        for( int first = 0, pair = 0; first < channelsToProcess; first += 2, ++pair )
+        {
+            auto& convolver = convolvers[(size_t) pair];
+            auto* input = convolver.getInputBlock() + position;
+            const auto* output = convolver.getOutputBlock() + position;
+
+            auto* a = block.getChannelPointer((size_t) first) + start;
+            auto* b = first + 1 < channelsToProcess ? block.getChannelPointer((size_t) first + 1) + start : nullptr;
+
+            for( int i = 0; i < chunk; ++i )
+            {
+                input[i] = { a[i], b != nullptr ? b[i] : 0.f };
+                a[i] = output[i].real();
+            }
+
+            if( b != nullptr )
+                for( int i = 0; i < chunk; ++i )
+                    b[i] = output[i].imag();
+        }
+
+        position += chunk;
+        start += chunk;
+
+        if( position == partitionSize )
+        {
+            takeNewestKernel();
+
+            for( auto& convolver : convolvers )
+                convolver.processBlock(engine->currentKernel, engine->fading ? &engine->previousKernel : nullptr);
+
+            engine->fading = false;
+            position = 0;
+        }
+    }
+}
+
+void LinearPhaseEQ::takeNewestKernel()
+{
+    if( kernelFifo.getNumAvailableForReading() == 0 )
+        return;
+
+    //the kernel that was playing becomes the one to fade out of, its old storage goes back into the fifo
+    std::swap(engine->previousKernel, engine->currentKernel);
+    while( kernelFifo.exchangePull(engine->currentKernel) ) {}
+
+    engine->fading = true;
+}
+
+void LinearPhaseEQ::buildEngine()
+{
+    designer.prepare(sampleRate, kernelLength, partitionSize);
+
+    auto newEngine = std::make_unique<Engine>();
+
+    newEngine->convolvers.resize((size_t) ((numChannels + 1) / 2));
+    for( auto& convolver : newEngine->convolvers )
+        convolver.prepare(partitionSize, numPartitionsPerKernel);
+
+    designedVersion = designVersion.load();
+    designer.design(cascadeSource(sampleRate), newEngine->currentKernel);
+    newEngine->previousKernel = newEngine->currentKernel;
+
+    delete builtEngine.exchange(newEngine.release());
+    builtVersion = preparedVersion;
+}
+
+int LinearPhaseEQ::useTimeSlice()
+{
+    if( ! enabled )
+        return 50;
+
+    const juce::ScopedLock sl(designLock);
+
+    if( sampleRate <= 0.0 )
+        return 10;
+
+    //first use since prepare(), later kernels are designed against this one
+    if( builtVersion != preparedVersion )
+    {
+        buildEngine();
+        return 0;
+    }
+
+    const auto version = designVersion.load();
+    if( version == designedVersion )
+        return 10;
+
+    //the audio thread hasn't taken the last kernel yet, it's picked up at most one partition from now
+    auto* kernel = kernelFifo.peekWrite();
+    if( kernel == nullptr )
+        return 2;
+
+    designedVersion = version;
+    designer.design(cascadeSource(sampleRate), *kernel);
+    kernelFifo.commitWrite();
+
+    return 0;
+}
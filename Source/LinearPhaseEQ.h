@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEQ.h
+    Linear phase mode: the magnitude response of the EQ cascade as a
+    symmetric FIR, designed on a background thread and run through a
+    PartitionedConvolver.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Fifo.h"
+#include "FusedCascade.h"
+#include "FrequencyResponse.h"
+#include "PartitionedConvolver.h"
+
+/**
+ hold it through a juce::SharedResourcePointer<LinearPhaseDesignThread>, like AnalyzerThread: one thread designs the
+ kernels of every instance in the process.
+ */
+class LinearPhaseDesignThread : public juce::TimeSliceThread
+{
+public:
+    LinearPhaseDesignThread() : juce::TimeSliceThread("SimpleEQ linear phase design")
+    {
+        startThread(4); //a new kernel should follow the knobs closely, but never at the audio thread's expense
+    }
+
+    ~LinearPhaseDesignThread() override
+    {
+        stopThread(2000);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (LinearPhaseDesignThread)
+};
+
+/**
+ samples |H| of a cascade on the FFT grid of the kernel length, takes it as a zero phase spectrum, transforms it back
+ and centres and windows the impulse. the result is a symmetric FIR of kernelLength taps whose group delay is
+ kernelLength / 2 at every frequency.
+ */
+class LinearPhaseDesigner
+{
+public:
+    /** allocates. */
+    void prepare(double sampleRate, int kernelLength, int partitionSize);
+
+    void design(const CascadeCoefficients<float>& cascade, PartitionedKernel& kernel);
+
+private:
+    int kernelLength = 0;
+    FrequencyResponse response; //at k * sampleRate / kernelLength, k = 0 .. kernelLength / 2
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<juce::dsp::Complex<float>> spectrum, impulse;
+    std::vector<float> window, taps;
+
+    KernelPartitioner partitioner;
+};
+
+/**
+ the EQ in linear phase. every channel pair of the bus shares one PartitionedConvolver (packed as a + jb) and all of
+ them share one kernel.
+
+ parameter changes only bump a version (requestDesign), the design thread builds the new kernel and hands it over
+ through a Fifo. process() picks it up at the next partition boundary and crossfades from the old kernel over that
+ partition, so the audio thread never designs, allocates or waits.
+
+ nothing but the sizes is set up until the mode is first used: the design thread allocates the convolvers and designs
+ the first kernel after setEnabled(true) and hands them over the same way, isReady() tells when they have arrived.
+ */
+class LinearPhaseEQ : public juce::TimeSliceClient
+{
+public:
+    //returns the cascade whose magnitude response the kernel follows, called on the design thread
+    using CascadeSource = std::function<CascadeCoefficients<float>(double sampleRate)>;
+
+    explicit LinearPhaseEQ(CascadeSource source);
+    ~LinearPhaseEQ() override;
+
+    /** taps of the kernel at this sample rate, 16384 at 44.1/48 kHz, doubling with the rate so the lowest cutoffs keep their shape. */
+    static int getKernelLength(double sampleRate);
+
+    /** sizes only, drops anything built for the last rate. call from prepareToPlay, never while process() may run. */
+    void prepare(double sampleRate, int numChannels);
+
+    /** audio thread. false until the design thread has built the convolvers and the first kernel since prepare(). */
+    bool isReady();
+
+    /**
+     builds the convolvers and the first kernel on the calling thread instead of waiting for the design thread, so
+     isReady() is true straight after. allocates and designs, only for offline rendering where nothing waits on the audio
+     thread. never while process() may run on another thread.
+     */
+    void buildNow();
+
+    /** clears the convolution history, the next getLatencyInSamples() samples come out silent. audio thread. */
+    void reset();
+
+    /** any thread. nothing is designed while disabled, re-enabling starts from the last kernel and fades to a fresh one. */
+    void setEnabled(bool shouldBeEnabled);
+
+    /** any thread. the design thread builds a kernel from the current settings. */
+    void requestDesign() { ++designVersion; }
+
+    /** audio thread. channels beyond the prepared count, and everything before isReady(), are left untouched. */
+    void process(const juce::dsp::AudioBlock<float>& block);
+
+    /** the kernel's group delay plus one partition of buffering in the convolver, known from prepare() on. */
+    int getLatencyInSamples() const { return latency; }
+
+    int useTimeSlice() override;
+
+private:
+    CascadeSource cascadeSource;
+    juce::SharedResourcePointer<LinearPhaseDesignThread> designThread;
+
+    //everything process() runs on
+    struct Engine
+    {
+        std::vector<PartitionedConvolver> convolvers; //one per channel pair
+        PartitionedKernel currentKernel, previousKernel;
+        bool fading = false;
+        int position = 0;
+    };
+
+    //prepare() and the design thread
+    juce::CriticalSection designLock;
+    LinearPhaseDesigner designer;
+    double sampleRate = 0.0;
+    int kernelLength = 0;
+    unsigned int designedVersion = 0, preparedVersion = 0, builtVersion = 0;
+
+    std::atomic<unsigned int> designVersion { 0 };
+    std::atomic<bool> enabled { false };
+
+    Fifo<PartitionedKernel, 3> kernelFifo;
+    std::atomic<Engine*> builtEngine { nullptr }; //handed to the audio thread, which takes ownership
+
+    //audio thread
+    std::unique_ptr<Engine> engine;
+    int numChannels = 0, partitionSize = 0, latency = 0;
+
+    void buildEngine();
+    void takeNewestKernel();
+
+    JUCE_DECLARE_NON_COPYABLE (LinearPhaseEQ)
+};
@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.cpp
+
+  ==============================================================================
+*/
+
+#include "PartitionedConvolver.h"
+
+void PartitionedKernel::setSize(int newPartitionSize, int newNumPartitions)
+{
+    partitionSize = newPartitionSize;
+    numPartitions = newNumPartitions;
+
+    const auto size = (size_t) (numPartitions * 2 * partitionSize);
+    real.assign(size, 0.f);
+    imag.assign(size, 0.f);
+}
+
+//==============================================================================
+void KernelPartitioner::prepare(int newPartitionSize)
+{
+    jassert(juce::isPowerOfTwo(newPartitionSize));
+
+    partitionSize = newPartitionSize;
+    fft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(2 * partitionSize)));
+
+    timeData.assign((size_t) (2 * partitionSize), {});
+    frequencyData.assign((size_t) (2 * partitionSize), {});
+}
+
+void KernelPartitioner::partition(const float* taps, int numTaps, PartitionedKernel& kernel)
+{
+    const auto numPartitions = (numTaps + partitionSize - 1) / partitionSize;
+
+    if( kernel.partitionSize != partitionSize || kernel.numPartitions != numPartitions )
+        kernel.setSize(partitionSize, numPartitions);
+
+    for( int p = 0; p < numPartitions; ++p )
+    {
+        const auto first = p * partitionSize;
+        const auto numInPartition = juce::jmin(partitionSize, numTaps - first);
+
+        std::fill(timeData.begin(), timeData.end(), juce::dsp::Complex<float>());
+        for( int i = 0; i < numInPartition; ++i )
+            timeData[(size_t) i] = { taps[first + i], 0.f };
+
+        fft->perform(timeData.data(), frequencyData.data(), false);
+
+        auto* real = kernel.real.data() + (size_t) (p * 2 * partitionSize);
+        auto* imag = kernel.imag.data() + (size_t) (p * 2 * partitionSize);
+        for( int k = 0; k < 2 * partitionSize; ++k )
+        {
+            real[k] = frequencyData[(size_t) k].real();
+            imag[k] = frequencyData[(size_t) k].imag();
+        }
+    }
+}
+
+//==============================================================================
+void PartitionedConvolver::prepare(int newPartitionSize, int newNumPartitions)
+{
+    jassert(juce::isPowerOfTwo(newPartitionSize) && newNumPartitions > 0);
+
+    partitionSize = newPartitionSize;
+    numPartitions = newNumPartitions;
+    fftSize = 2 * partitionSize;
+
+    fft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(fftSize)));
+
+    timeData.resize((size_t) fftSize);
+    spectrum.resize((size_t) fftSize);
+    outputData.resize((size_t) fftSize);
+    fadeData.resize((size_t) fftSize);
+
+    delayLineReal.resize((size_t) (numPartitions * fftSize));
+    delayLineImag.resize((size_t) (numPartitions * fftSize));
+    accumulatorReal.resize((size_t) fftSize);
+    accumulatorImag.resize((size_t) fftSize);
+
+    reset();
+}
+
+void PartitionedConvolver::reset()
+{
+    std::fill(timeData.begin(), timeData.end(), Complex());
+    std::fill(outputData.begin(), outputData.end(), Complex());
+    std::fill(delayLineReal.begin(), delayLineReal.end(), 0.f);
+    std::fill(delayLineImag.begin(), delayLineImag.end(), 0.f);
+    newestSlot = 0;
+}
+
+void PartitionedConvolver::processBlock(const PartitionedKernel& kernel, const PartitionedKernel* fadingOut)
+{
+    jassert(kernel.partitionSize == partitionSize && kernel.numPartitions <= numPartitions);
+
+    //the newest input spectrum replaces the oldest one in the delay line
+    newestSlot = newestSlot == 0 ? numPartitions - 1 : newestSlot - 1;
+
+    fft->perform(timeData.data(), spectrum.data(), false);
+
+    auto* real = delayLineReal.data() + (size_t) (newestSlot * fftSize);
+    auto* imag = delayLineImag.data() + (size_t) (newestSlot * fftSize);
+    for( int k = 0; k < fftSize; ++k )
+    {
+        real[k] = spectrum[(size_t) k].real();
+        imag[k] = spectrum[(size_t) k].imag();
+    }
+
+    //overlap-save: this block is the first half of the next FFT's input
+    std::copy(timeData.begin() + partitionSize, timeData.end(), timeData.begin());
+
+    accumulate(kernel);
+    inverseTransform(outputData.data());
+
+    if( fadingOut != nullptr )
+    {
+        accumulate(*fadingOut);
+        inverseTransform(fadeData.data());
+
+        const auto step = 1.f / float(partitionSize);
+        for( int i = 0; i < partitionSize; ++i )
+        {
+            const auto gain = float(i + 1) * step;
+            auto& out = outputData[(size_t) (partitionSize + i)];
+            out = fadeData[(size_t) (partitionSize + i)] * (1.f - gain) + out * gain;
+        }
+    }
+}
+
+void PartitionedConvolver::accumulate(const PartitionedKernel& kernel)
+{
+    std::fill(accumulatorReal.begin(), accumulatorReal.end(), 0.f);
+    std::fill(accumulatorImag.begin(), accumulatorImag.end(), 0.f);
+
+    auto* accReal = accumulatorReal.data();
+    auto* accImag = accumulatorImag.data();
+
+    //partition p meets the input from p blocks ago
+    for( int p = 0, slot = newestSlot; p < kernel.numPartitions; ++p, slot = slot + 1 == numPartitions ? 0 : slot + 1 )
+    {
+        const auto* xReal = delayLineReal.data() + (size_t) (slot * fftSize);
+        const auto* xImag = delayLineImag.data() + (size_t) (slot * fftSize);
+        const auto* hReal = kernel.getReal(p);
+        const auto* hImag = kernel.getImag(p);
+
+        //(xr + j xi)(hr + j hi) in split form, four vectorized passes over arrays that stay in cache
+        juce::FloatVectorOperations::addWithMultiply(accReal, xReal, hReal, fftSize);
+        juce::FloatVectorOperations::subtractWithMultiply(accReal, xImag, hImag, fftSize);
+        juce::FloatVectorOperations::addWithMultiply(accImag, xReal, hImag, fftSize);
+        juce::FloatVectorOperations::addWithMultiply(accImag, xImag, hReal, fftSize);
+    }
+}
+
+void PartitionedConvolver::inverseTransform(Complex* destination)
+{
+    for( int k = 0; k < fftSize; ++k )
+        spectrum[(size_t) k] = { accumulatorReal[(size_t) k], accumulatorImag[(size_t) k] };
+
+    //juce's inverse FFT scales by 1 / fftSize, so nothing else to normalize. the second half is the valid part
+    fft->perform(spectrum.data(), destination, true);
+}
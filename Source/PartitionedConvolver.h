@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.h
+    Uniformly partitioned overlap-save convolution for long FIR kernels,
+    two channels per complex FFT.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ the spectra of an FIR kernel cut into partitions of B taps: partition p holds taps [pB, (p + 1)B), zero padded to 2B
+ and transformed. real and imaginary parts are kept in separate arrays so the multiply-accumulate runs on
+ FloatVectorOperations.
+ */
+struct PartitionedKernel
+{
+    int partitionSize = 0, numPartitions = 0;
+    std::vector<float> real, imag; //numPartitions blocks of 2 * partitionSize bins
+
+    /** allocates. */
+    void setSize(int newPartitionSize, int newNumPartitions);
+
+    const float* getReal(int partition) const { return real.data() + (size_t) (partition * 2 * partitionSize); }
+    const float* getImag(int partition) const { return imag.data() + (size_t) (partition * 2 * partitionSize); }
+};
+
+/**
+ turns FIR taps into a PartitionedKernel. owns the FFT and scratch space so it can be reused for every design.
+ */
+class KernelPartitioner
+{
+public:
+    /** allocates. */
+    void prepare(int partitionSize);
+
+    /** numTaps may be anything, the last partition is zero padded. 'kernel' is resized if it has to be. */
+    void partition(const float* taps, int numTaps, PartitionedKernel& kernel);
+
+private:
+    int partitionSize = 0;
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<juce::dsp::Complex<float>> timeData, frequencyData;
+};
+
+/**
+ convolves two channels with the same real kernel. the channels are packed as a + jb: the kernel is real, so the
+ convolution of the packed signal is conv(a, h) + j conv(b, h) and the two outputs come straight back out of the real
+ and imaginary parts, with no separation step. one forward and one inverse FFT per block serve both channels.
+
+ every block of B input samples is transformed once (2B points, overlap-save) and kept in a frequency domain delay line,
+ each output block is the sum over partitions of (input spectrum p blocks ago) * (kernel partition p), which costs
+ 2 * numPartitions complex multiply-adds per sample pair. input and output are in blocks of B, the caller buffers
+ around that, so the convolver adds B samples of latency on top of the kernel's own.
+ */
+class PartitionedConvolver
+{
+public:
+    using Complex = juce::dsp::Complex<float>;
+
+    /** allocates, and clears the history. */
+    void prepare(int partitionSize, int numPartitions);
+
+    /** forgets all input, the next outputs are silence until new input arrives. */
+    void reset();
+
+    int getPartitionSize() const { return partitionSize; }
+
+    /** where the caller writes the next B input samples, first channel in the real part, second in the imaginary part. */
+    Complex* getInputBlock() { return timeData.data() + partitionSize; }
+
+    /** the output for the previous input block, valid until the next processBlock(). */
+    const Complex* getOutputBlock() const { return outputData.data() + partitionSize; }
+
+    /**
+     convolves the input block with 'kernel'. if 'fadingOut' is given the block is also convolved with it and the output
+     fades from the old kernel to the new one across the block, both share the same delay line so nothing restarts.
+     */
+    void processBlock(const PartitionedKernel& kernel, const PartitionedKernel* fadingOut);
+
+private:
+    int partitionSize = 0, numPartitions = 0, fftSize = 0;
+    int newestSlot = 0; //the delay line slot holding the newest input spectrum
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+
+    std::vector<Complex> timeData;     //[previous block | current block], overlap-save input
+    std::vector<Complex> spectrum;     //forward FFT output and inverse FFT input
+    std::vector<Complex> outputData, fadeData;
+
+    std::vector<float> delayLineReal, delayLineImag; //numPartitions spectra
+    std::vector<float> accumulatorReal, accumulatorImag;
+
+    void accumulate(const PartitionedKernel& kernel);
+    void inverseTransform(Complex* destination);
+};
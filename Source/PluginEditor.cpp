@@ -178,11 +178,9 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 // ==============================================================================
 
 ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) :
+juce::ComponentMovementWatcher(this),
 audioProcessor(p),
-//leftChannelFifo(&audioProcessor.leftChannelFifo)
-
-leftPathProducer(audioProcessor.leftChannelFifo),
-rightPathProducer(audioProcessor.rightChannelFifo)
+pathProducer(audioProcessor.analyzerRing)
 {
     const auto& params = audioProcessor.getParameters();
     for(auto param : params)
@@ -191,11 +189,20 @@ rightPathProducer(audioProcessor.rightChannelFifo)
     }
     
     updateChain();
-    startTimerHz(60);
+    
+    analyzerThread->addTimeSliceClient(&pathProducer);
+    
+    //the timer and the tap start once the component is on screen
+    updateActivity();
 }
 
 ResponseCurveComponent::~ResponseCurveComponent()
 {
+    setActive(false);
+    
+    //waits for the producer to finish if the analyzer thread is inside it
+    analyzerThread->removeTimeSliceClient(&pathProducer);
+    
     const auto& params = audioProcessor.getParameters();
     for(auto param : params)
     {
@@ -209,145 +216,258 @@ void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float new
 
 void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
 {
-    juce::AudioBuffer<float> tempIncomingBuffer;
+    const auto fftSize = stereoFFTDataGenerator.getFFTSize();
+    
+    /* 48000(sample rate) / 2048(order) = 23Hz  <-- this the bin width*/
+    
+    const auto binWidth = sampleRate / (double)fftSize;
+    
+    //fixed-hop STFT: frames end on multiples of the hop, however the host happens to slice its blocks,
+    //so the FFT rate is sampleRate / hopSize per channel at any buffer size
+    const auto hopSize = fftSize >> overlap.load();
+    const auto writePosition = sampleRing->getWritePosition();
+    const auto newestWindowEnd = writePosition - writePosition % hopSize;
+    
+    if (resumed.exchange(false))
+    {
+        freshFrom = writePosition;
+        drewSilence = {};
+    }
+    
+    if (fftBounds != silenceBounds || sampleRate != silenceSampleRate)
+    {
+        silenceBounds = fftBounds;
+        silenceSampleRate = sampleRate;
+        drewSilence = {};
+    }
     
-    while (leftChannelFifo->getNumCompleteBuffersAvailable() > 0)
+    //the processor was re-prepared, or frames piled up faster than they'd be drawn: skip to the newest ones
+    if (writePosition < lastWindowEnd || newestWindowEnd - lastWindowEnd > maxFramesPerSlice * hopSize)
     {
-        if (leftChannelFifo->getAudioBuffer(tempIncomingBuffer))
+        lastWindowEnd = juce::jmax<juce::int64>(0, newestWindowEnd - maxFramesPerSlice * hopSize);
+        freshFrom = juce::jmin(freshFrom, writePosition);
+    }
+    
+    while (lastWindowEnd + hopSize <= writePosition)
+    {
+        //the message thread hasn't taken the last paths yet, nothing we computed now would be drawn
+        if (! pathProducers[0].canAcceptPath() || ! pathProducers[1].canAcceptPath())
         {
-            auto size = tempIncomingBuffer.getNumSamples();
-            
-            //moves the old wavelenths to the left, get the size of the incoming wavelengths and move the old wavelengths by that much
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0),
-                                              monoBuffer.getReadPointer(0, size),
-                                              monoBuffer.getNumSamples() - size);
-            
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size), tempIncomingBuffer.getReadPointer(0, 0), size);
-            
-            leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
-            /* if there are FFT data buffers to pull
-                if we can pull a buffer
-                    generate a path
-             */
-            
-            const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
-            
-            /* 48000(sample rate) / 2048(order) = 23Hz  <-- this the bin width*/
-            
-            const auto binWidth = sampleRate / (double)fftSize;
+            lastWindowEnd = newestWindowEnd;
+            break;
+        }
+        
+        lastWindowEnd += hopSize;
+        
+        //the window would still start in samples from before the tap was switched back on
+        if (lastWindowEnd - fftSize < freshFrom)
+            continue;
+        
+        /* if there are FFT data buffers to pull
+            if we can pull a buffer
+                generate a path
+         */
+        
+        if (stereoPacking)
+        {
+            //one complex FFT for both channels, its outputs are indexed like the channels passed in
+            if (! stereoFFTDataGenerator.produceFFTDataForRendering(*sampleRing, { Channel::Right, Channel::Left }, lastWindowEnd, -48.f))
+                continue;
             
-            while (leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0)
+            while (stereoFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0)
             {
-                std::vector<float> fftData;
-                if (leftChannelFFTDataGenerator.getFFTData(fftData))
+                for (int channel : { Channel::Right, Channel::Left })
                 {
-                    pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -48.f);
+                    if (auto* fftData = stereoFFTDataGenerator.peekFFTData(channel))
+                    {
+                        if (! isRepeatedSilence(channel, *fftData, fftSize / 2, -48.f))
+                            pathProducers[(size_t) channel].generatePath(*fftData, fftBounds, fftSize, binWidth, -48.f);
+                        stereoFFTDataGenerator.finishedWithFFTData(channel);
+                    }
                 }
             }
-            
-            /*
-             while there are paths that can be pulled
-                pull as many as we can
-                    display the most recent path
-             */
-            
-            while (pathProducer.getNumPathsAvailable())
+        }
+        else
+        {
+            for (int channel : { Channel::Right, Channel::Left })
             {
-                pathProducer.getPath(leftChannelFFTPath);
+                auto& generator = fftDataGenerators[(size_t) channel];
+                if (! generator.produceFFTDataForRendering(*sampleRing, channel, lastWindowEnd, -48.f))
+                    continue;
+                
+                while (generator.getNumAvailableFFTDataBlocks() > 0)
+                {
+                    if (auto* fftData = generator.peekFFTData())
+                    {
+                        if (! isRepeatedSilence(channel, *fftData, fftSize / 2, -48.f))
+                            pathProducers[(size_t) channel].generatePath(*fftData, fftBounds, fftSize, binWidth, -48.f);
+                        generator.finishedWithFFTData();
+                    }
+                }
             }
-            
         }
     }
 }
 
+bool PathProducer::isRepeatedSilence(int channel, const std::vector<float>& fftData, int numBins, float negativeInfinity)
+{
+    //a frame with every bin at the floor draws the same flat line as the last one, so the path isn't rebuilt or published
+    auto silent = juce::FloatVectorOperations::findMaximum(fftData.data(), numBins) <= negativeInfinity;
+    auto repeated = silent && drewSilence[(size_t) channel];
+    drewSilence[(size_t) channel] = silent;
+    return repeated;
+}
+
+void PathProducer::setRenderArea(juce::Rectangle<float> fftBounds, double sampleRate)
+{
+    const juce::SpinLock::ScopedLockType sl(renderAreaLock);
+    renderBounds = fftBounds;
+    renderSampleRate = sampleRate;
+}
+
+int PathProducer::useTimeSlice()
+{
+    juce::Rectangle<float> fftBounds;
+    double sampleRate;
+    {
+        const juce::SpinLock::ScopedLockType sl(renderAreaLock);
+        fftBounds = renderBounds;
+        sampleRate = renderSampleRate;
+    }
+    
+    if (sampleRate > 0.0 && ! fftBounds.isEmpty())
+        process(fftBounds, sampleRate);
+    
+    return AnalyzerThread::serviceIntervalMs;
+}
+
+bool PathProducer::pullLatestPaths()
+{
+    /*
+     while there are paths that can be pulled
+        pull as many as we can
+            display the most recent path
+     */
+    
+    bool gotPath = false;
+    for (int channel : { Channel::Right, Channel::Left })
+    {
+        auto& generator = pathProducers[(size_t) channel];
+        while (generator.getNumPathsAvailable())
+        {
+            gotPath = generator.getPath(channelFFTPaths[(size_t) channel]) || gotPath;
+        }
+    }
+    
+    return gotPath;
+}
+
 void ResponseCurveComponent::timerCallback()
 {
+    //minimising the window sends no ComponentMovementWatcher callback, it's caught here and polled for slowly until restored
+    if (! isShowing())
+    {
+        setActive(false);
+        startTimer(hiddenPollIntervalMs);
+        return;
+    }
+    
+    if (! active)
+    {
+        setActive(true);
+        return;
+    }
     
     auto fftBounds = getAnalysisArea().toFloat();
     auto sampleRate = audioProcessor.getSampleRate();
     
-    leftPathProducer.process(fftBounds, sampleRate);
-    rightPathProducer.process(fftBounds, sampleRate);
+    //the FFTs run on the analyzer thread, here we only hand over the layout and pick up the finished paths
+    pathProducer.setRenderArea(fftBounds, sampleRate);
+    auto needsRepaint = pathProducer.pullLatestPaths();
     
-    if (parametersChanged.compareAndSetBool(false, true))
+    if (parametersChanged.compareAndSetBool(false, true) || getResponseSampleRate() != responseSampleRate)
     {
 //        DBG("params changed");
-        //update monochain
+        //update the cached response curve
         updateChain();
         //signal repaint
-//        repaint();
+        needsRepaint = true;
     }
     
-    repaint();
+    //nothing to draw while the host is idle, the input is silent (see PathProducer::isRepeatedSilence) and the knobs are still
+    if (needsRepaint)
+        repaint();
 }
 
-void ResponseCurveComponent::updateChain()
+void ResponseCurveComponent::setMaxRepaintRate(int newRateHz)
 {
-    auto chainSettings = getChainSettings(audioProcessor.apvts);
-    auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
+    maxRepaintRateHz = juce::jmax(1, newRateHz);
     
-    updateLowCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings);
-    updateHighCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings);
+    if (active)
+        startTimerHz(maxRepaintRateHz);
 }
 
-void ResponseCurveComponent::paint (juce::Graphics& g)
+void ResponseCurveComponent::updateActivity()
 {
-    
-    using namespace juce;
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll (Colours::black);
-    
-    g.drawImage(background, getLocalBounds().toFloat());
+    //isShowing() also covers hidden parents. a minimised window is only noticed by timerCallback
+    setActive(isShowing());
+}
 
-//    auto responseArea = getLocalBounds();
-    auto responseArea = getAnalysisArea();//getRenderArea();
-    
-    auto w = responseArea.getWidth();
+void ResponseCurveComponent::setActive(bool shouldBeActive)
+{
+    if (active == shouldBeActive)
+        return;
     
-    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& highcut = monoChain.get<ChainPositions::HighCut>();
+    active = shouldBeActive;
     
+    if (active)
+    {
+        pathProducer.resume();
+        audioProcessor.addAnalyzerClient();
+        parametersChanged.set(true); //anything that changed while hidden is picked up on the first tick
+        startTimerHz(maxRepaintRateHz);
+    }
+    else
+    {
+        stopTimer();
+        audioProcessor.removeAnalyzerClient();
+    }
+}
+
+double ResponseCurveComponent::getResponseSampleRate() const
+{
     auto sampleRate = audioProcessor.getSampleRate();
+    return sampleRate > 0.0 ? sampleRate : 44100.0;
+}
+
+void ResponseCurveComponent::updateChain()
+{
+    using namespace juce;
     
-    std::vector<double> mags;
+    auto responseArea = getAnalysisArea();
+    auto w = responseArea.getWidth();
+    auto sampleRate = getResponseSampleRate();
     
-    mags.resize(w);
+    if (w <= 0)
+        return;
     
-    for(int i = 0; i < w; ++i)
+    //one frequency per pixel column, these only move with the width or the sample rate
+    if (w != responseWidth || sampleRate != responseSampleRate)
     {
-        double mag = 1.f;
-        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
-        
-        if (!monoChain.isBypassed<ChainPositions::Peak>())
-            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        
-        if (!lowcut.isBypassed<0>())
-            mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!lowcut.isBypassed<1>())
-            mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!lowcut.isBypassed<2>())
-            mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!lowcut.isBypassed<3>())
-            mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        
-        if (!highcut.isBypassed<0>())
-            mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!highcut.isBypassed<1>())
-            mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!highcut.isBypassed<2>())
-            mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!highcut.isBypassed<3>())
-            mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        
-        mags[i] = Decibels::gainToDecibels(mag);
+        std::vector<double> freqs((size_t) w);
+        for (int i = 0; i < w; ++i)
+            freqs[(size_t) i] = mapToLog10(double(i) / double(w), 20.0, 20000.0);
+        
+        responseCache.setFrequencies(freqs.data(), w, sampleRate);
+        responseWidth = w;
+        responseSampleRate = sampleRate;
     }
     
-    Path responseCurve;
+    auto chainSettings = getChainSettings(audioProcessor.apvts);
+    if (! responseCache.update(audioProcessor.designActiveCascade(chainSettings, sampleRate)))
+        return;
+    
+    const auto* mags = responseCache.getMagnitudesInDecibels();
     
     const double outputMin = responseArea.getBottom();
     const double outputMax = responseArea.getY();
@@ -356,25 +476,36 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
         return jmap(input, -24.0, 24.0, outputMin, outputMax);
     };
     
-    responseCurve.startNewSubPath(responseArea.getX(), map(mags.front()));
+    responseCurve.clear();
+    responseCurve.startNewSubPath(responseArea.getX(), map(mags[0]));
     
-    for (size_t i = 1; i < mags.size(); ++i)
+    for (int i = 1; i < w; ++i)
     {
         responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
     }
+}
+
+void ResponseCurveComponent::paint (juce::Graphics& g)
+{
     
-    auto leftChannelFFTPath = leftPathProducer.getPath();
-    leftChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()-10));
+    using namespace juce;
+    // (Our component is opaque, so we must completely fill the background with a solid colour)
+    g.fillAll (Colours::black);
+    
+    g.drawImage(background, getLocalBounds().toFloat());
+
+//    auto responseArea = getLocalBounds();
+    auto responseArea = getAnalysisArea();//getRenderArea();
+    
+    //the analyzer paths are stroked where they are, translated on the fly instead of copied
+    auto fftTransform = AffineTransform().translation(responseArea.getX(), responseArea.getY()-10);
     
     //fft draw
     g.setColour(Colour(16u, 169u, 255u));
-    g.strokePath(leftChannelFFTPath, PathStrokeType(1.f));
-    
-    auto rightChannelFFTPath = rightPathProducer.getPath();
-    rightChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()-10));
+    g.strokePath(pathProducer.getPath(Channel::Left), PathStrokeType(1.f), fftTransform);
     
     g.setColour(Colour(255u, 147u, 88u));
-    g.strokePath(rightChannelFFTPath, PathStrokeType(1.f));
+    g.strokePath(pathProducer.getPath(Channel::Right), PathStrokeType(1.f), fftTransform);
     
     //renderarea draw
     g.setColour(Colours::orange);
@@ -383,6 +514,17 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
     //response curve draw
     g.setColour(Colours::white);
     g.strokePath(responseCurve, PathStrokeType(2.f));
+    
+   #if SIMPLEEQ_RT_CHECKS
+    //profiling builds: anything processBlock allocated or locked since the plugin loaded
+    auto& rtLog = RealtimeSafety::getEventLog();
+    g.setColour(rtLog.getNumEvents() > 0 ? Colours::red : Colours::limegreen);
+    g.setFont(10.f);
+    g.drawFittedText("RT: " + String(rtLog.getNumAllocations()) + " new, "
+                     + String(rtLog.getNumDeallocations()) + " delete, "
+                     + String(rtLog.getNumLocks()) + " locks",
+                     getAnalysisArea().removeFromTop(12), Justification::topRight, 1);
+   #endif
         
 }
 
@@ -508,6 +650,10 @@ void ResponseCurveComponent::resized()
         g.setColour(Colours::lightgrey);
         g.drawFittedText(str, r, juce::Justification::centred, 1);
     }
+    
+    //the response curve is laid out in component coordinates, rebuild it for the new area
+    responseWidth = -1;
+    updateChain();
 }
 
 juce::Rectangle<int> ResponseCurveComponent::getRenderArea()
@@ -542,8 +688,8 @@ peakGainSlider(*audioProcessor.apvts.getParameter("Peak Gain"), "dB"),
 peakQualitySlider(*audioProcessor.apvts.getParameter("Peak Quality"), ""),
 lowCutFreqSlider(*audioProcessor.apvts.getParameter("LowCut Freq"), "Hz"),
 highCutFreqSlider(*audioProcessor.apvts.getParameter("HighCut Freq"), "Hz"),
-lowCutSlopeSlider(*audioProcessor.apvts.getParameter("LowCut Slope"), "dB/Oct"),
-highCutSlopeSlider(*audioProcessor.apvts.getParameter("HighCut Slope"), "dB/Oct"),
+lowCutSlopeSlider(*audioProcessor.apvts.getParameter("LowCut Slope v2"), "dB/Oct"),
+highCutSlopeSlider(*audioProcessor.apvts.getParameter("HighCut Slope v2"), "dB/Oct"),
 
 responseCurveComponent(audioProcessor),
 peakFreqSliderAttachment(audioProcessor.apvts, "Peak Freq", peakFreqSlider),
@@ -551,8 +697,8 @@ peakGainSliderAttachment(audioProcessor.apvts, "Peak Gain", peakGainSlider),
 peakQualitySliderAttachment(audioProcessor.apvts, "Peak Quality", peakQualitySlider),
 lowCutFreqSliderAttachment(audioProcessor.apvts, "LowCut Freq", lowCutFreqSlider),
 highCutFreqSliderAttachment(audioProcessor.apvts, "HighCut Freq", highCutFreqSlider),
-lowCutSlopeSliderAttachment(audioProcessor.apvts, "LowCut Slope", lowCutSlopeSlider),
-highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlopeSlider)
+lowCutSlopeSliderAttachment(audioProcessor.apvts, "LowCut Slope v2", lowCutSlopeSlider),
+highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope v2", highCutSlopeSlider)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -573,10 +719,10 @@ highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlope
     highCutFreqSlider.labels.add({1.f, "20kHz"});
     
     lowCutSlopeSlider.labels.add({0.f, "12"});
-    lowCutSlopeSlider.labels.add({1.f, "48"});
+    lowCutSlopeSlider.labels.add({1.f, "96"});
     
     highCutSlopeSlider.labels.add({0.f, "12"});
-    highCutSlopeSlider.labels.add({1.f, "48"});
+    highCutSlopeSlider.labels.add({1.f, "96"});
     
     
     
@@ -10,6 +10,8 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "AnalyzerThread.h"
+#include "FastDecibels.h"
 
 enum FFTOrder
 {
@@ -18,19 +20,38 @@ enum FFTOrder
     order8192 = 13
 };
 
+//how much consecutive analyzer frames overlap, the value is the hop as a shift of the FFT size (hop = fftSize >> value)
+enum AnalyzerOverlap
+{
+    overlap50 = 1,
+    overlap75 = 2,
+    overlap875 = 3
+};
+
 template<typename BlockType>
 struct FFTDataGenerator
 {
     /**
-     produces the FFT data from an audio buffer.
+     produces the FFT data from the fftSize samples of 'channel' that end at 'windowEnd'.
+     returns false if the ring no longer (or doesn't yet) hold them.
      */
-    void produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData, const float negativeInfinity)
+    bool produceFFTDataForRendering(const SampleRing& ring, int channel, juce::int64 windowEnd, const float negativeInfinity)
     {
         const auto fftSize = getFFTSize();
         
-        fftData.assign(fftData.size(), 0);
-        auto* readIndex = audioData.getReadPointer(0);
-        std::copy(readIndex, readIndex + fftSize, fftData.begin());
+        //rendered in place in the next free fifo slot, the frame is dropped if the reader hasn't kept up
+        auto* slot = fftDataFifo.peekWrite();
+        if( slot == nullptr )
+            return false;
+        
+        auto& fftData = *slot;
+        
+        //the window is copied straight out of the ring into the FFT buffer, it overwrites [0, fftSize).
+        //only the upper half still holds the previous frame's bins
+        if( ! ring.readWindow(channel, windowEnd, fftData.data(), fftSize) )
+            return false;
+        
+        juce::FloatVectorOperations::clear(fftData.data() + fftSize, fftSize);
         
         // first apply a windowing function to our data
         window->multiplyWithWindowingTable (fftData.data(), fftSize);       // [1]
@@ -38,31 +59,10 @@ struct FFTDataGenerator
         // then render our FFT data..
         forwardFFT->performFrequencyOnlyForwardTransform (fftData.data());  // [2]
         
-        int numBins = (int)fftSize / 2;
+        convertMagnitudesToDecibels(fftData.data(), (int)fftSize / 2, negativeInfinity);
         
-        //normalize the fft values.
-        for( int i = 0; i < numBins; ++i )
-        {
-            auto v = fftData[i];
-//            fftData[i] /= (float) numBins;
-            if( !std::isinf(v) && !std::isnan(v) )
-            {
-                v /= float(numBins);
-            }
-            else
-            {
-                v = 0.f;
-            }
-            fftData[i] = v;
-        }
-        
-        //convert them to decibels
-        for( int i = 0; i < numBins; ++i )
-        {
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
-        }
-        
-        fftDataFifo.push(fftData);
+        fftDataFifo.commitWrite();
+        return true;
     }
     
     void changeOrder(FFTOrder newOrder)
@@ -77,23 +77,105 @@ struct FFTDataGenerator
         forwardFFT = std::make_unique<juce::dsp::FFT>(order);
         window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
         
-        fftData.clear();
-        fftData.resize(fftSize * 2, 0);
-
-        fftDataFifo.prepare(fftData.size());
+        fftDataFifo.prepare((size_t) fftSize * 2);
     }
     //==============================================================================
     int getFFTSize() const { return 1 << order; }
     int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
     //==============================================================================
-    bool getFFTData(BlockType& fftData) { return fftDataFifo.pull(fftData); }
+    //the oldest frame, used in place. hand it back with finishedWithFFTData()
+    const BlockType* peekFFTData() { return fftDataFifo.peekRead(); }
+    void finishedWithFFTData() { fftDataFifo.commitRead(); }
 private:
     FFTOrder order;
-    BlockType fftData;
     std::unique_ptr<juce::dsp::FFT> forwardFFT;
     std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
     
-    Fifo<BlockType> fftDataFifo;
+    Fifo<BlockType, 4> fftDataFifo;
+};
+
+/**
+ analyzes two channels with a single complex FFT: the first channel goes into the real part, the second into
+ the imaginary part, and the two spectra are separated afterwards with the conjugate symmetry of real signals
+
+     A[k] = (Z[k] + conj(Z[N-k])) / 2        B[k] = (Z[k] - conj(Z[N-k])) / 2j
+
+ one transform and one windowing pass instead of two of each. the bins match what FFTDataGenerator produces
+ for each channel on its own (up to float rounding). frames come out of two fifos, indexed like 'channels'.
+ */
+template<typename BlockType>
+struct StereoFFTDataGenerator
+{
+    bool produceFFTDataForRendering(const SampleRing& ring, const std::array<int, 2>& channels, juce::int64 windowEnd, const float negativeInfinity)
+    {
+        const auto fftSize = getFFTSize();
+        
+        auto* slotA = fftDataFifos[0].peekWrite();
+        auto* slotB = fftDataFifos[1].peekWrite();
+        if( slotA == nullptr || slotB == nullptr )
+            return false;
+        
+        //the slots double as scratch space for the raw windows
+        auto* a = slotA->data();
+        auto* b = slotB->data();
+        if( ! ring.readWindow(channels[0], windowEnd, a, fftSize) || ! ring.readWindow(channels[1], windowEnd, b, fftSize) )
+            return false;
+        
+        //one windowing pass for both channels, packed as a + jb
+        for( int i = 0; i < fftSize; ++i )
+            timeData[(size_t) i] = { a[i] * windowTable[(size_t) i], b[i] * windowTable[(size_t) i] };
+        
+        forwardFFT->perform(timeData.data(), frequencyData.data(), false);
+        
+        const int numBins = fftSize / 2;
+        for( int k = 0; k < numBins; ++k )
+        {
+            auto z = frequencyData[(size_t) k];
+            auto mirrored = std::conj(frequencyData[(size_t) ((fftSize - k) & (fftSize - 1))]);
+            a[k] = std::abs(z + mirrored) * 0.5f;
+            b[k] = std::abs(z - mirrored) * 0.5f;
+        }
+        
+        convertMagnitudesToDecibels(a, numBins, negativeInfinity);
+        convertMagnitudesToDecibels(b, numBins, negativeInfinity);
+        
+        fftDataFifos[0].commitWrite();
+        fftDataFifos[1].commitWrite();
+        return true;
+    }
+    
+    void changeOrder(FFTOrder newOrder)
+    {
+        order = newOrder;
+        auto fftSize = getFFTSize();
+        
+        forwardFFT = std::make_unique<juce::dsp::FFT>(order);
+        
+        //same table FFTDataGenerator's WindowingFunction uses
+        windowTable.resize((size_t) fftSize);
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(windowTable.data(), (size_t) fftSize,
+                                                                 juce::dsp::WindowingFunction<float>::blackmanHarris);
+        
+        timeData.assign((size_t) fftSize, {});
+        frequencyData.assign((size_t) fftSize, {});
+        
+        for( auto& fifo : fftDataFifos )
+            fifo.prepare((size_t) fftSize);
+    }
+    //==============================================================================
+    int getFFTSize() const { return 1 << order; }
+    int getNumAvailableFFTDataBlocks() const { return fftDataFifos[0].getNumAvailableForReading(); }
+    //==============================================================================
+    //the oldest frame of channels[index], used in place. hand it back with finishedWithFFTData(index)
+    const BlockType* peekFFTData(int index) { return fftDataFifos[(size_t) index].peekRead(); }
+    void finishedWithFFTData(int index) { fftDataFifos[(size_t) index].commitRead(); }
+private:
+    FFTOrder order;
+    std::unique_ptr<juce::dsp::FFT> forwardFFT;
+    std::vector<float> windowTable;
+    std::vector<juce::dsp::Complex<float>> timeData, frequencyData;
+    
+    std::array<Fifo<BlockType, 4>, 2> fftDataFifos;
 };
 
 template<typename PathType>
@@ -112,10 +194,14 @@ struct AnalyzerPathGenerator
         auto bottom = fftBounds.getHeight();
         auto width = fftBounds.getWidth();
 
-        int numBins = (int)fftSize / 2;
-
-        PathType p;
-        p.preallocateSpace(3 * (int)fftBounds.getWidth());
+        //built in place in the next free slot, whose storage is recycled from an earlier path
+        auto* slot = pathFifo.peekWrite();
+        if( slot == nullptr )
+            return;
+        
+        PathType& p = *slot;
+        p.clear();
+        p.preallocateSpace(3 * (2 * (int)fftBounds.getWidth() + 1));
 
         auto map = [bottom, top, negativeInfinity](float v)
         {
@@ -132,37 +218,82 @@ struct AnalyzerPathGenerator
         
         p.startNewSubPath(0, y);
 
-        const int pathResolution = 2; //you can draw line-to's every 'pathResolution' pixels.
+        updateColumnTable(width, fftSize, binWidth);
 
-        for( int binNum = 1; binNum < numBins; binNum += pathResolution )
+        //one min/max pair per pixel column: every bin counts, but the path never has more than 2 points per pixel
+        for( const auto& column : columns )
         {
-            y = map(renderData[binNum]);
-
-//            jassert( !std::isnan(y) && !std::isinf(y) );
+            auto range = juce::FloatVectorOperations::findMinAndMax(renderData.data() + column.firstBin, column.numBins);
+            auto yMax = map(range.getEnd());
+            auto yMin = map(range.getStart());
 
-            if( !std::isnan(y) && !std::isinf(y) )
-            {
-                auto binFreq = binNum * binWidth;
-                auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
-                int binX = std::floor(normalizedBinX * width);
-                p.lineTo(binX, y);
-            }
+            p.lineTo(column.x, yMax);
+            if( yMin - yMax >= 0.5f )
+                p.lineTo(column.x, yMin);
         }
 
-        pathFifo.push(p);
+        pathFifo.commitWrite();
     }
 
     int getNumPathsAvailable() const
     {
         return pathFifo.getNumAvailableForReading();
     }
+    
+    //false while every slot holds a path the message thread hasn't picked up yet
+    bool canAcceptPath() const
+    {
+        return pathFifo.getFreeSpace() > 0;
+    }
 
     bool getPath(PathType& path)
     {
-        return pathFifo.pull(path);
+        return pathFifo.exchangePull(path); //'path's old storage goes back into the fifo
     }
 private:
-    Fifo<PathType> pathFifo;
+    Fifo<PathType, 4> pathFifo;
+    
+    //the bins that land on pixel column 'x', only columns with at least one bin are kept
+    struct Column
+    {
+        float x;
+        int firstBin, numBins;
+    };
+    
+    std::vector<Column> columns;
+    float tableWidth = -1.f, tableBinWidth = -1.f;
+    int tableFFTSize = -1;
+    
+    //the bin -> pixel mapping only changes with the bounds, FFT size or sample rate
+    void updateColumnTable(float width, int fftSize, float binWidth)
+    {
+        if( width == tableWidth && fftSize == tableFFTSize && binWidth == tableBinWidth )
+            return;
+        
+        tableWidth = width;
+        tableFFTSize = fftSize;
+        tableBinWidth = binWidth;
+        
+        columns.clear();
+        
+        const int numBins = (int)fftSize / 2;
+        for( int binNum = 1; binNum < numBins; ++binNum )
+        {
+            auto binFreq = binNum * binWidth;
+            if( binFreq < 20.f )
+                continue;
+            
+            auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
+            auto binX = std::floor(normalizedBinX * width);
+            if( binX >= width )
+                break;
+            
+            if( ! columns.empty() && columns.back().x == binX )
+                ++columns.back().numBins;
+            else
+                columns.push_back({ binX, binNum, 1 });
+        }
+    }
 };
 
 struct LookAndFeel : juce::LookAndFeel_V4
@@ -209,32 +340,71 @@ private:
     juce::String suffix;
 };
 
-struct PathProducer
+/**
+ turns both channels of the analyzer ring into drawable paths.
+ the FFTs and path building run on the shared AnalyzerThread (useTimeSlice), the message thread only
+ tells it where to draw (setRenderArea) and picks up finished paths (pullLatestPaths).
+ */
+struct PathProducer : juce::TimeSliceClient
 {
-    PathProducer(SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType> &scsf) :
-    leftChannelFifo(&scsf)
+    PathProducer(SampleRing& ring) :
+    sampleRing(&ring)
     {
-        leftChannelFFTDataGenerator.changeOrder(FFTOrder::order2048); //change order to 4096 or 8192 for more resolution in the bass (lower freqs) WILL COST MORE CPU RESOURCES
+        //change order to 4096 or 8192 for more resolution in the bass (lower freqs) WILL COST MORE CPU RESOURCES
+        for( auto& generator : fftDataGenerators )
+            generator.changeOrder(FFTOrder::order2048);
         
-        monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+        stereoFFTDataGenerator.changeOrder(FFTOrder::order2048);
     }
-    void process(juce::Rectangle<float> fftBounds, double sampleRate);
-    juce::Path getPath() {return leftChannelFFTPath;}
+    
+    //message thread
+    void setRenderArea(juce::Rectangle<float> fftBounds, double sampleRate);
+    void setOverlap(AnalyzerOverlap newOverlap) { overlap = newOverlap; }
+    //true: both channels share one complex FFT. false: a real FFT per channel
+    void setStereoPacking(bool shouldPack) { stereoPacking = shouldPack; }
+    //the processor's tap was off until now, so the ring's history is stale and no frame may reach back into it
+    void resume() { resumed = true; }
+    bool pullLatestPaths();
+    const juce::Path& getPath(Channel channel) const {return channelFFTPaths[(size_t) channel];}
+    
+    //analyzer thread
+    int useTimeSlice() override;
 private:
-    SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType> *leftChannelFifo;
+    void process(juce::Rectangle<float> fftBounds, double sampleRate);
+    bool isRepeatedSilence(int channel, const std::vector<float>& fftData, int numBins, float negativeInfinity);
+    
+    SampleRing* sampleRing;
+    juce::int64 lastWindowEnd = 0; //ring position the last analyzed window ended at
+    juce::int64 freshFrom = 0; //the first ring position written since resume()
+    std::atomic<bool> resumed { false };
     
-    juce::AudioBuffer<float> monoBuffer;
+    //per Channel: the last path published was the flat line of a silent frame, drawn at these bounds
+    std::array<bool, 2> drewSilence {};
+    juce::Rectangle<float> silenceBounds;
+    double silenceSampleRate = 0.0;
+    std::atomic<AnalyzerOverlap> overlap { AnalyzerOverlap::overlap50 };
+    std::atomic<bool> stereoPacking { true };
     
-    FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
+    //frames further behind than this are skipped, only the newest ones would ever be drawn
+    static constexpr int maxFramesPerSlice = 2;
     
-    AnalyzerPathGenerator<juce::Path> pathProducer;
+    juce::SpinLock renderAreaLock;
+    juce::Rectangle<float> renderBounds;
+    double renderSampleRate = 0.0;
     
-    juce::Path leftChannelFFTPath;
+    //everything per channel is indexed by Channel
+    std::array<FFTDataGenerator<std::vector<float>>, 2> fftDataGenerators;
+    StereoFFTDataGenerator<std::vector<float>> stereoFFTDataGenerator;
+    
+    std::array<AnalyzerPathGenerator<juce::Path>, 2> pathProducers;
+    
+    std::array<juce::Path, 2> channelFFTPaths; //the newest paths, owned by the message thread
 };
 
 struct ResponseCurveComponent : juce::Component,
 juce::AudioProcessorParameter::Listener,
-juce::Timer
+juce::Timer,
+juce::ComponentMovementWatcher
 {
     ResponseCurveComponent(SimpleEQAudioProcessor& );
     ~ResponseCurveComponent();
@@ -247,13 +417,35 @@ juce::Timer
     void paint(juce::Graphics& g) override;
     void resized() override; 
     
+    //upper limit on repaints per second. a tick only repaints if a new analyzer frame arrived or the parameters moved
+    void setMaxRepaintRate(int newRateHz);
+    
+    //ComponentMovementWatcher: this component or a parent was shown, hidden or put in another window
+    using juce::ComponentMovementWatcher::componentMovedOrResized;
+    using juce::ComponentMovementWatcher::componentVisibilityChanged;
+    void componentMovedOrResized(bool wasMoved, bool wasResized) override {}
+    void componentPeerChanged() override { updateActivity(); }
+    void componentVisibilityChanged() override { updateActivity(); }
+    
 private:
     SimpleEQAudioProcessor& audioProcessor;
     juce::Atomic<bool> parametersChanged {false};
     
-    MonoChain monoChain;
+    //while not showing the timer is stopped and the processor's analyzer tap is off. minimised, it only polls for the restore
+    int maxRepaintRateHz = 60;
+    static constexpr int hiddenPollIntervalMs = 500;
+    bool active = false;
+    void updateActivity();
+    void setActive(bool shouldBeActive);
+    
+    //the response at every pixel column of the analysis area, only re-evaluated when a section changes
+    FrequencyResponse responseCache;
+    juce::Path responseCurve;
+    int responseWidth = -1;
+    double responseSampleRate = 0.0;
     
     void updateChain();
+    double getResponseSampleRate() const;
     
     juce::Image background;
     
@@ -261,7 +453,8 @@ private:
     
     juce::Rectangle<int> getAnalysisArea();
     
-    PathProducer leftPathProducer, rightPathProducer;
+    juce::SharedResourcePointer<AnalyzerThread> analyzerThread;
+    PathProducer pathProducer;
 };
 
 //==============================================================================
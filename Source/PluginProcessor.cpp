@@ -22,10 +22,22 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                        )
 #endif
 {
+    for (auto* param : getParameters())
+    {
+        if (auto* rangedParam = dynamic_cast<juce::RangedAudioParameter*>(param))
+            apvts.addParameterListener(rangedParam->paramID, this);
+    }
+    
+    linearPhaseParameter = apvts.getRawParameterValue("Linear Phase");
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    for (auto* param : getParameters())
+    {
+        if (auto* rangedParam = dynamic_cast<juce::RangedAudioParameter*>(param))
+            apvts.removeParameterListener(rangedParam->paramID, this);
+    }
 }
 
 //==============================================================================
@@ -63,7 +75,17 @@ bool SimpleEQAudioProcessor::isMidiEffect() const
 
 double SimpleEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    const auto sampleRate = getSampleRate();
+    return sampleRate > 0.0 ? getTailLengthInSamples(isLinearPhaseOn()) / sampleRate : 0.0;
+}
+
+double SimpleEQAudioProcessor::getTailLengthInSamples(bool linearPhase) const
+{
+    //the FIR is kernelLength taps centred on its latency, plus the partition the convolver buffers
+    if (linearPhase)
+        return (double) (LinearPhaseEQ::getKernelLength(getSampleRate()) / 2 + linearPhaseEQ.getLatencyInSamples());
+    
+    return iirTailInSamples;
 }
 
 int SimpleEQAudioProcessor::getNumPrograms()
@@ -104,8 +126,52 @@ void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     
     spec.sampleRate = sampleRate;
     
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    coefficientTable = useCoefficientTables ? CoefficientTable::getForSampleRate(sampleRate) : nullptr;
+    
+    //one lane per channel of the bus, whatever the layout
+    spec.numChannels = (juce::uint32) juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels());
+    const auto useDouble = isUsingDoublePrecision();
+    
+    //only the path for the host's precision is used, the other one gives its memory back
+    activeTopology = filterTopology;
+    const auto useSVF = activeTopology == FilterTopology::stateVariable;
+    
+    //only sizes and the latency here, the convolvers and the first kernel are built on the design thread once the mode is on
+    const auto linearPhase = isLinearPhaseOn();
+    linearPhaseEQ.prepare(sampleRate, (int) spec.numChannels);
+    linearPhaseEQ.setEnabled(linearPhase);
+    
+    //offline nothing waits on us, and what's rendered mustn't depend on how soon the design thread gets round to it
+    if (linearPhase && isNonRealtime())
+        linearPhaseEQ.buildNow();
+    
+    auto preparePath = [&spec, samplesPerBlock, useSVF, historyLength = linearPhaseEQ.getLatencyInSamples()](auto& path, bool used)
+    {
+        const auto unused = juce::dsp::ProcessSpec { spec.sampleRate, 0, 0 };
+        path.chainBank.prepare(used && ! useSVF ? spec : unused);
+        path.svfBank.prepare(used && useSVF ? spec : unused);
+        path.modeSwitchBuffer.setSize(used ? (int) spec.numChannels : 0, used ? samplesPerBlock : 0);
+        path.latencyHistory.setSize(used ? (int) spec.numChannels : 0, used ? historyLength : 0);
+        path.latencyHistory.clear();
+        path.historyPosition = 0;
+    };
+    preparePath(floatPath, ! useDouble);
+    preparePath(doublePath, useDouble);
+    
+    for (auto& ramp : frequencyRamps)
+        ramp.assign(useSVF ? (size_t) juce::jmax(1, samplesPerBlock) : 0, 0.f);
+    
+    //the SVF path always ramps, from wherever the parameters are now
+    if (useSVF)
+        smoothedSettings.reset(sampleRate, smoothingRampSeconds, getChainSettings(apvts));
+    
+    //from a standstill the delayed recursive output starts as silent as the FIR would, it fades over once the FIR is built.
+    //a FIR that's already there starts from the same silence and plays on its own
+    const auto firReady = linearPhase && linearPhaseEQ.isReady();
+    activePhaseMode = firReady ? PhaseMode::linear : linearPhase ? PhaseMode::enteringLinear : PhaseMode::recursive;
+    linearPhaseSamplesHeard = firReady ? 0 : -1;
+    linearPhaseBuffer.setSize(useDouble ? (int) spec.numChannels : 0, useDouble ? samplesPerBlock : 0);
+    setLatencySamples(linearPhase ? linearPhaseEQ.getLatencyInSamples() : 0);
     
     /*
     auto chainSettings = getChainSettings(apvts);
@@ -132,10 +198,15 @@ void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     */
     
     //DOES ALL THE ABOVE COMMENTED WORK
-    updateFilters();
+    markAllFiltersDirty(); //sample rate may have changed, redesign everything
+    snapBandMix = true;
+    activeSubBlockSize = 0; //processBlock restarts the ramps at the new sample rate if smoothing is on
+    if (useDouble)
+        updateFilters<double>();
+    else
+        updateFilters<float>();
     
-    leftChannelFifo.prepare(samplesPerBlock);
-    rightChannelFifo.prepare(samplesPerBlock);
+    analyzerRing.prepare(2, analyzerHistorySize, juce::jmax(1, samplesPerBlock));
     
     osc.initialise([](float x) {return std::sin(x); });
     
@@ -158,12 +229,9 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout works (mono, stereo, surround such as 7.1.4, ambisonics),
+    // the chain bank is sized from it in prepareToPlay.
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -177,8 +245,27 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 }
 #endif
 
+bool SimpleEQAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
 void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    juce::ignoreUnused(midiMessages);
+    processSamples(buffer);
+}
+
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    processSamples(buffer);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer)
+{
+    RealtimeSafety::ScopedRealtimeScope realtimeScope; //logs allocations and locks in profiling builds, see RealtimeSafety.h
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -191,6 +278,32 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     // this code if your algorithm always overwrites all the output channels.
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
+    
+    //into linear phase the recursive filters keep running, delayed by the latency, until the FIR has caught up.
+    //out of it they start clean if the FIR was playing on its own
+    const bool linearPhase = isLinearPhaseOn();
+    const auto previousPhaseMode = activePhaseMode;
+    if (linearPhase && activePhaseMode == PhaseMode::recursive)
+    {
+        activePhaseMode = PhaseMode::enteringLinear;
+    }
+    else if (! linearPhase && activePhaseMode != PhaseMode::recursive)
+    {
+        activePhaseMode = PhaseMode::recursive;
+        
+        if (previousPhaseMode == PhaseMode::linear)
+        {
+            linearPhaseSamplesHeard = -1; //the FIR stops here, the next entry starts it from a clean history
+            getPath<SampleType>().chainBank.reset();
+            getPath<SampleType>().svfBank.reset();
+            markAllFiltersDirty();
+            snapBandMix = true;
+            activeSubBlockSize = 0; //smoothing restarts its ramps from the current values below
+            
+            if (activeTopology == FilterTopology::stateVariable)
+                smoothedSettings.reset(getSampleRate(), smoothingRampSeconds, getChainSettings(apvts));
+        }
+    }
    
     /*
     auto chainSettings = getChainSettings(apvts);
@@ -219,9 +332,43 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     updateHighCutFilter(rightHighCut, highCutCoefficients, chainSettings);
     */
     
-    updateFilters();
+    //switching smoothing on starts the ramps from the current values, switching it off jumps to the targets
+    const int subBlockSize = smoothingSubBlockSize;
+    if (subBlockSize != activeSubBlockSize)
+    {
+        if (subBlockSize > 0 && activeSubBlockSize == 0)
+            smoothedSettings.reset(getSampleRate(), smoothingRampSeconds, getChainSettings(apvts));
+        else if (subBlockSize == 0)
+            markAllFiltersDirty();
+        
+        activeSubBlockSize = subBlockSize;
+    }
     
-    juce::dsp::AudioBlock<float> block(buffer);
+    updateFilters<SampleType>();
+    
+    //silence in and the tail has rung out: silence out, without running anything
+    if (updateSleep(buffer, linearPhase))
+    {
+        buffer.clear();
+        
+        //nothing moves the ramps along while asleep, so they jump to their targets and wake up designed there
+        for (size_t i = 0; i < pendingSmoothedDesign.size(); ++i)
+        {
+            if (smoothedSettings.isSmoothing(static_cast<ChainPositions>(i)))
+            {
+                smoothedSettings.snapToTargets();
+                pendingSmoothedDesign = { true, true, true };
+                break;
+            }
+        }
+        
+        if (numAnalyzerClients.load(std::memory_order_relaxed) > 0)
+            analyzerRing.push(buffer);
+        
+        return;
+    }
+    
+    juce::dsp::AudioBlock<SampleType> block(buffer);
     
     //UNCOMMENT FOR TESTING PURPOSES
 //    buffer.clear();
@@ -229,19 +376,55 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
 //    juce::dsp::ProcessContextReplacing<float> stereoContext(block);
 //    osc.process(stereoContext);
     
-    //block representing individual channel
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    auto& modeSwitchBuffer = getPath<SampleType>().modeSwitchBuffer;
+    const bool leavingLinearPhase = previousPhaseMode == PhaseMode::linear && activePhaseMode == PhaseMode::recursive;
     
-    //context kind of a wrapper around the block to pass to Chain
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    if (previousPhaseMode == PhaseMode::enteringLinear || activePhaseMode == PhaseMode::enteringLinear)
+    {
+        processLinearPhaseEntry(buffer, previousPhaseMode);
+    }
+    else if (leavingLinearPhase && modeSwitchBuffer.getNumSamples() > 0)
+    {
+        //both modes run on this block and the output crossfades from the FIR to the recursive filters.
+        //a block longer than prepared goes through in modeSwitchBuffer sized chunks along the same fade
+        const auto numChannels = juce::jmin(buffer.getNumChannels(), modeSwitchBuffer.getNumChannels());
+        const auto numSamples = buffer.getNumSamples();
+        const auto maxChunk = modeSwitchBuffer.getNumSamples();
+        
+        for (int start = 0; start < numSamples; start += maxChunk)
+        {
+            const auto chunk = juce::jmin(maxChunk, numSamples - start);
+            const auto fadeStart = (SampleType) start / (SampleType) numSamples;
+            const auto fadeEnd = (SampleType) (start + chunk) / (SampleType) numSamples;
+            
+            for (int channel = 0; channel < numChannels; ++channel)
+                modeSwitchBuffer.copyFrom(channel, 0, buffer, channel, start, chunk);
+            
+            auto firBlock = block.getSubBlock((size_t) start, (size_t) chunk);
+            auto switchedBlock = juce::dsp::AudioBlock<SampleType>(modeSwitchBuffer).getSubsetChannelBlock(0, (size_t) numChannels)
+                                                                               .getSubBlock(0, (size_t) chunk);
+            processFilters(firBlock, true);
+            processFilters(switchedBlock, false);
+            
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                buffer.applyGainRamp(channel, start, chunk, SampleType(1) - fadeStart, SampleType(1) - fadeEnd);
+                buffer.addFromWithRamp(channel, start, modeSwitchBuffer.getReadPointer(channel), chunk, fadeStart, fadeEnd);
+            }
+        }
+    }
+    else
+    {
+        processFilters(block, activePhaseMode == PhaseMode::linear);
+    }
     
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    //whatever plays now is what a switch into linear phase replays, delayed by the latency
+    if (activePhaseMode != PhaseMode::enteringLinear)
+        recordLatencyHistory(buffer);
     
-    leftChannelFifo.update(buffer);
-    rightChannelFifo.update(buffer);
+    //headless, or the editor is closed or hidden: nobody would ever read these samples
+    if (numAnalyzerClients.load(std::memory_order_relaxed) > 0)
+        analyzerRing.push(buffer);
     
 
     // This is the place where you'd normally do the guts of your plugin's
@@ -290,9 +473,17 @@ void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBy
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
     if(tree.isValid())
     {
-        apvts.replaceState(tree);
-        updateFilters();
+        //state saved before 72 and 96 dB/oct has the slopes under their old IDs. the saved choice index is the same slope
+        for (auto [oldID, newID] : { std::pair<const char*, const char*> { "LowCut Slope", "LowCut Slope v2" },
+                                     std::pair<const char*, const char*> { "HighCut Slope", "HighCut Slope v2" } })
+        {
+            auto oldParameter = tree.getChildWithProperty("id", oldID);
+            if (oldParameter.isValid() && ! tree.getChildWithProperty("id", newID).isValid())
+                oldParameter.setProperty("id", newID, nullptr);
+        }
         
+        //replaceState notifies parameterChanged, the next processBlock picks up the new versions
+        apvts.replaceState(tree);
     }
 }
 
@@ -305,106 +496,688 @@ ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
     settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
     settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
     settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
+    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope v2")->load());
+    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope v2")->load());
     
     return settings;
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+template<typename NumericType>
+void designPeakFilter(BiquadCoefficients<NumericType>& peakCoefficients, const ChainSettings& chainSettings, double sampleRate)
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-                                                               chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+    CoefficientDesign::makePeak(peakCoefficients, sampleRate,
+                                chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(double(chainSettings.peakGainInDecibels)));
 }
 
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings)
+template<typename NumericType>
+void designLowCutFilter(CutCoefficients<NumericType>& cutCoefficients, const ChainSettings& chainSettings, double sampleRate)
+{
+    CoefficientDesign::makeButterworthHighPass(cutCoefficients, chainSettings.lowCutFreq, sampleRate, getCutOrder(chainSettings.lowCutSlope));
+}
+
+template<typename NumericType>
+void designHighCutFilter(CutCoefficients<NumericType>& cutCoefficients, const ChainSettings& chainSettings, double sampleRate)
+{
+    CoefficientDesign::makeButterworthLowPass(cutCoefficients, chainSettings.highCutFreq, sampleRate, getCutOrder(chainSettings.highCutSlope));
+}
+
+template<typename NumericType>
+CascadeCoefficients<NumericType> designCascade(const ChainSettings& chainSettings, double sampleRate)
 {
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+    BiquadCoefficients<NumericType> peak;
+    CutCoefficients<NumericType> lowCut, highCut;
+    designPeakFilter(peak, chainSettings, sampleRate);
+    designLowCutFilter(lowCut, chainSettings, sampleRate);
+    designHighCutFilter(highCut, chainSettings, sampleRate);
     
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    CascadeCoefficients<NumericType> cascade;
+    cascade.setLowCut(lowCut);
+    cascade.setPeak(peak);
+    cascade.setHighCut(highCut);
+    return cascade;
 }
 
-void /*SimpleEQAudioProcessor::*/updateCoefficients(Coefficients &old, const Coefficients &replacements)
+float getBandDeviationInDecibels(ChainPositions band, const ChainSettings& chainSettings, double sampleRate)
 {
-    *old = *replacements;
+    //what the check considers audible
+    constexpr double lowestFrequency = 20.0, highestFrequency = 20000.0;
+    
+    //bilinear butterworth of order n: |H|^2 = 1 / (1 + r^2n), r = tan(pi f / fs) / tan(pi fc / fs) for a low pass, 1 / r for a high pass.
+    //both are monotonic, so the worst point is the audible edge on the cut side
+    auto cutDeviation = [sampleRate](double cutoff, double edge, int order, bool highPass)
+    {
+        auto warp = [sampleRate](double frequency)
+        {
+            return std::tan(juce::MathConstants<double>::pi * juce::jmin(frequency, 0.49 * sampleRate) / sampleRate);
+        };
+        
+        auto ratio = highPass ? warp(cutoff) / warp(edge) : warp(edge) / warp(cutoff);
+        return (float) (10.0 * std::log10(1.0 + std::pow(ratio, 2 * order)));
+    };
+    
+    switch (band)
+    {
+        //a peak is furthest from flat at its centre, where |H| is exactly the gain
+        case Peak:
+            return std::abs(chainSettings.peakGainInDecibels);
+        case LowCut:
+            return cutDeviation(chainSettings.lowCutFreq, lowestFrequency, getCutOrder(chainSettings.lowCutSlope), true);
+        case HighCut:
+            return cutDeviation(chainSettings.highCutFreq, highestFrequency, getCutOrder(chainSettings.highCutSlope), false);
+    }
+    
+    return 0.f;
+}
+
+template void designPeakFilter<float>(BiquadCoefficients<float>&, const ChainSettings&, double);
+template void designPeakFilter<double>(BiquadCoefficients<double>&, const ChainSettings&, double);
+template void designLowCutFilter<float>(CutCoefficients<float>&, const ChainSettings&, double);
+template void designLowCutFilter<double>(CutCoefficients<double>&, const ChainSettings&, double);
+template void designHighCutFilter<float>(CutCoefficients<float>&, const ChainSettings&, double);
+template void designHighCutFilter<double>(CutCoefficients<double>&, const ChainSettings&, double);
+template CascadeCoefficients<float> designCascade<float>(const ChainSettings&, double);
+template CascadeCoefficients<double> designCascade<double>(const ChainSettings&, double);
+
+void SimpleEQAudioProcessor::getFrequencyResponse(const double* frequencies, double* magnitudesInDecibels, int numFrequencies)
+{
+    const auto sampleRate = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+    
+    FrequencyResponse response;
+    response.setFrequencies(frequencies, numFrequencies, sampleRate);
+    response.update(designActiveCascade(getChainSettings(apvts), sampleRate));
+    
+    std::copy(response.getMagnitudesInDecibels(), response.getMagnitudesInDecibels() + numFrequencies, magnitudesInDecibels);
+}
+
+CascadeCoefficients<float> SimpleEQAudioProcessor::designActiveCascade(const ChainSettings& chainSettings, double sampleRate) const
+{
+    auto cascade = designCascade(chainSettings, sampleRate);
+    const auto tolerance = bypassTolerance.load();
+    
+    for (int band = 0; band < CascadeCoefficients<float>::numBands; ++band)
+        if (getBandDeviationInDecibels(static_cast<ChainPositions>(band), chainSettings, sampleRate) <= tolerance)
+            cascade.setBandMix(band, 0.f);
+    
+    return cascade;
 }
 
+template<typename SampleType>
+void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings)
+{
+    auto& path = getPath<SampleType>();
+    
+    if (coefficientTable != nullptr)
+        coefficientTable->designPeak(path.peakCoefficients, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+    else
+        designPeakFilter(path.peakCoefficients, chainSettings, getSampleRate());
+    
+    path.chainBank.setPeak(path.peakCoefficients);
+}
 
+template<typename SampleType>
 void SimpleEQAudioProcessor::lowCutFiltersImplemented(const ChainSettings &chainSettings)
 {
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
-//    auto lowCutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, getSampleRate(), 2*(chainSettings.lowCutSlope+1)); //last formula is derived from the implementation of IIRHighpass..., slope choice = 0,1,2,3 therefore order = 2,4,6,8 = 2*((0,1,2,3)+1)
+    auto& path = getPath<SampleType>();
     
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    updateLowCutFilter(leftLowCut, lowCutCoefficients, chainSettings);//custom function to refactor cutFilter LOOK AT DEFINITION
+    if (coefficientTable != nullptr)
+        coefficientTable->designButterworthHighPass(path.lowCutCoefficients, chainSettings.lowCutFreq, getCutOrder(chainSettings.lowCutSlope));
+    else
+        designLowCutFilter(path.lowCutCoefficients, chainSettings, getSampleRate());
+//    auto lowCutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, getSampleRate(), 2*(chainSettings.lowCutSlope+1)); //last formula is derived from the implementation of IIRHighpass..., slope choice = 0,1,2,3 therefore order = 2,4,6,8 = 2*((0,1,2,3)+1)
     
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
-    updateLowCutFilter(rightLowCut, lowCutCoefficients, chainSettings); //custom function to refactor cutFilter LOOK AT DEFINITION
+    path.chainBank.setLowCut(path.lowCutCoefficients);
 }
 
+template<typename SampleType>
 void SimpleEQAudioProcessor::highCutFiltersImplemented(const ChainSettings &chainSettings)
 {
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
+    auto& path = getPath<SampleType>();
     
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
+    if (coefficientTable != nullptr)
+        coefficientTable->designButterworthLowPass(path.highCutCoefficients, chainSettings.highCutFreq, getCutOrder(chainSettings.highCutSlope));
+    else
+        designHighCutFilter(path.highCutCoefficients, chainSettings, getSampleRate());
     
-    updateHighCutFilter(leftHighCut, highCutCoefficients, chainSettings); //left
-    updateHighCutFilter(rightHighCut, highCutCoefficients, chainSettings); //right
+    path.chainBank.setHighCut(path.highCutCoefficients);
 }
 
+template<typename SampleType>
 void SimpleEQAudioProcessor::updateFilters()
 {
+    //read the versions before the settings so a change that lands in between is picked up next block
+    std::array<bool, 3> changed;
+    bool anyChanged = false;
+    
+    for (size_t i = 0; i < changed.size(); ++i)
+    {
+        auto version = parameterVersions[i].load();
+        changed[i] = version != appliedVersions[i];
+        appliedVersions[i] = version;
+        anyChanged = anyChanged || changed[i];
+    }
+    
+    if (! anyChanged)
+        return;
+    
     auto chainSettings = getChainSettings(apvts);
     
-    lowCutFiltersImplemented(chainSettings);
-    highCutFiltersImplemented(chainSettings);
-    updatePeakFilter(chainSettings);
+    if (activeSubBlockSize > 0 || activeTopology == FilterTopology::stateVariable)
+    {
+        //processSmoothed/processStateVariable redesign along the ramp
+        smoothedSettings.setTarget(chainSettings);
+        for (size_t i = 0; i < changed.size(); ++i)
+            pendingSmoothedDesign[i] = pendingSmoothedDesign[i] || changed[i];
+        return;
+    }
+    
+    applyChainSettings<SampleType>(chainSettings, changed);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::applyChainSettings(const ChainSettings& chainSettings, const std::array<bool, 3>& groupsToUpdate)
+{
+    if (groupsToUpdate[ChainPositions::LowCut])
+        lowCutFiltersImplemented<SampleType>(chainSettings);
+    if (groupsToUpdate[ChainPositions::HighCut])
+        highCutFiltersImplemented<SampleType>(chainSettings);
+    if (groupsToUpdate[ChainPositions::Peak])
+        updatePeakFilter<SampleType>(chainSettings);
+    
+    //bands that are as good as flat drop out of the cascade, processChainBank fades them out and back in
+    const auto tolerance = bypassTolerance.load();
+    for (size_t band = 0; band < bandBypassed.size(); ++band)
+        if (groupsToUpdate[band])
+            bandBypassed[band] = getBandDeviationInDecibels(static_cast<ChainPositions>(band), chainSettings, getSampleRate()) <= tolerance;
+    
+    //the tail of the groups just designed, from the coefficients they were designed into
+    auto& path = getPath<SampleType>();
+    if (groupsToUpdate[ChainPositions::LowCut])
+        bandTailInSamples[LowCut] = CoefficientDesign::getDecayInSamples(path.lowCutCoefficients, tailThreshold);
+    if (groupsToUpdate[ChainPositions::HighCut])
+        bandTailInSamples[HighCut] = CoefficientDesign::getDecayInSamples(path.highCutCoefficients, tailThreshold);
+    if (groupsToUpdate[ChainPositions::Peak])
+        bandTailInSamples[Peak] = CoefficientDesign::getDecayInSamples(path.peakCoefficients, tailThreshold);
+    
+    updateTailLength();
+}
+
+void SimpleEQAudioProcessor::updateTailLength()
+{
+    //the biquads leave bypassed bands out, the SVFs run every band
+    const auto allBands = activeTopology == FilterTopology::stateVariable;
+    
+    double total = 0.0;
+    for (size_t band = 0; band < bandTailInSamples.size(); ++band)
+        if (allBands || ! bandBypassed[band])
+            total += bandTailInSamples[band];
+    
+    iirTailInSamples = total;
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processSmoothed(juce::dsp::AudioBlock<SampleType>& block, int subBlockSize)
+{
+    const auto numSamples = block.getNumSamples();
+    
+    for (size_t start = 0; start < numSamples; start += (size_t) subBlockSize)
+    {
+        const auto subBlockLength = juce::jmin((size_t) subBlockSize, numSamples - start);
+        
+        //redesign once per sub-block, only for the groups that are still moving
+        std::array<bool, 3> moving;
+        bool anyMoving = false;
+        for (size_t i = 0; i < moving.size(); ++i)
+        {
+            moving[i] = pendingSmoothedDesign[i] || smoothedSettings.isSmoothing(static_cast<ChainPositions>(i));
+            anyMoving = anyMoving || moving[i];
+        }
+        
+        auto settings = smoothedSettings.skip((int) subBlockLength);
+        
+        if (anyMoving)
+        {
+            applyChainSettings<SampleType>(settings, moving);
+            pendingSmoothedDesign = {};
+        }
+        
+        processChainBank(block.getSubBlock(start, subBlockLength));
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processChainBank(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    auto& chainBank = getPath<SampleType>().chainBank;
+    
+    if (snapBandMix)
+    {
+        for (size_t band = 0; band < bandMix.size(); ++band)
+        {
+            bandMix[band] = bandBypassed[band] ? 0.f : 1.f;
+            chainBank.setBandMix((int) band, SampleType(bandMix[band]));
+        }
+        
+        snapBandMix = false;
+    }
+    
+    //while a band is fading the block goes through in steps of bypassRampStepSize, otherwise in one go
+    const auto mixStep = (float) (bypassRampStepSize / (bypassRampSeconds * getSampleRate()));
+    
+    for (size_t start = 0; start < block.getNumSamples();)
+    {
+        bool fading = false;
+        for (size_t band = 0; band < bandMix.size(); ++band)
+        {
+            const auto target = bandBypassed[band] ? 0.f : 1.f;
+            if (bandMix[band] == target)
+                continue;
+            
+            bandMix[band] = target > bandMix[band] ? juce::jmin(target, bandMix[band] + mixStep)
+                                                   : juce::jmax(target, bandMix[band] - mixStep);
+            chainBank.setBandMix((int) band, SampleType(bandMix[band]));
+            fading = true;
+        }
+        
+        const auto numSamples = fading ? juce::jmin(bypassRampStepSize, block.getNumSamples() - start) : block.getNumSamples() - start;
+        chainBank.process(block.getSubBlock(start, numSamples));
+        start += numSamples;
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processStateVariable(juce::dsp::AudioBlock<SampleType>& block)
+{
+    auto& svfBank = getPath<SampleType>().svfBank;
+    const auto maxChunk = frequencyRamps[0].size();
+    
+    for (size_t start = 0; start < block.getNumSamples() && maxChunk > 0; start += maxChunk)
+    {
+        const auto numSamples = juce::jmin(maxChunk, block.getNumSamples() - start);
+        
+        //slopes, Q and gain only change k and the output mix, once per chunk. frequencies move every sample
+        std::array<bool, 3> redesign;
+        for (size_t i = 0; i < redesign.size(); ++i)
+            redesign[i] = pendingSmoothedDesign[i] || smoothedSettings.isSmoothing(static_cast<ChainPositions>(i));
+        pendingSmoothedDesign = {};
+        
+        std::array<bool, 3> ramping;
+        auto settings = smoothedSettings.skipPerSample((int) numSamples,
+                                                       { frequencyRamps[LowCut].data(), frequencyRamps[Peak].data(), frequencyRamps[HighCut].data() },
+                                                       ramping);
+        
+        if (redesign[LowCut])
+            svfBank.setLowCut(settings.lowCutFreq, getCutOrder(settings.lowCutSlope));
+        if (redesign[HighCut])
+            svfBank.setHighCut(settings.highCutFreq, getCutOrder(settings.highCutSlope));
+        if (redesign[Peak])
+            svfBank.setPeak(settings.peakFreq, settings.peakQuality, juce::Decibels::decibelsToGain(settings.peakGainInDecibels));
+
+        
+        svfBank.process(block.getSubBlock(start, numSamples),
+                        ramping[LowCut] ? frequencyRamps[LowCut].data() : nullptr,
+                        ramping[Peak] ? frequencyRamps[Peak].data() : nullptr,
+                        ramping[HighCut] ? frequencyRamps[HighCut].data() : nullptr);
+        
+        //the groups that moved, at the frequency they ended the chunk on
+        bool tailChanged = false;
+        for (size_t i = 0; i < redesign.size(); ++i)
+        {
+            if (redesign[i] || ramping[i])
+            {
+                bandTailInSamples[i] = svfBank.getDecayInSamples((int) i, tailThreshold);
+                tailChanged = true;
+            }
+        }
+        
+        if (tailChanged)
+            updateTailLength();
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processFilters(juce::dsp::AudioBlock<SampleType>& block, bool linearPhase)
+{
+    if (linearPhase)
+    {
+        processLinearPhase(block);
+    }
+    else if (isDualMono(block))
+    {
+        //same input, same state: the right channel would come out bit for bit the same as the left
+        auto left = block.getSingleChannelBlock(0);
+        processRecursive(left);
+        block.getSingleChannelBlock(1).copyFrom(left);
+        
+        //and ends up in the same state, so the next block can go either way
+        getPath<SampleType>().svfBank.copyChannelState(0, 1);
+    }
+    else
+    {
+        processRecursive(block);
+    }
+}
+
+template<typename SampleType>
+bool SimpleEQAudioProcessor::isDualMono(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    //only the SVFs run channel by channel, the biquads would run the same SIMD register for one channel as for two
+    if (! dualMonoDetection || activeTopology != FilterTopology::stateVariable
+        || block.getNumChannels() != 2 || getTotalNumOutputChannels() != 2)
+        return false;
+    
+    //memcmp is vectorized in any C library worth using and stops at the first difference, on real stereo that's the first few samples
+    if (std::memcmp(block.getChannelPointer(0), block.getChannelPointer(1), block.getNumSamples() * sizeof(SampleType)) != 0)
+        return false;
+    
+    return getPath<SampleType>().svfBank.areChannelStatesEqual(0, 1);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processRecursive(juce::dsp::AudioBlock<SampleType>& block)
+{
+    if (activeTopology == FilterTopology::stateVariable)
+        processStateVariable(block);
+    //channels are interleaved into SIMD lanes and each group is filtered in a single pass
+    else if (activeSubBlockSize > 0)
+        processSmoothed(block, activeSubBlockSize);
+    else
+        processChainBank(block);
+}
+
+template<typename SampleType>
+bool SimpleEQAudioProcessor::updateSleep(const juce::AudioBuffer<SampleType>& buffer, bool linearPhase)
+{
+    //getMagnitude is a vectorized min/max per channel, and free for buffers already flagged clear.
+    //only exact zeros are silence, anything quieter than tailThreshold is still real input that must come out filtered
+    if (! sleepEnabled || buffer.getMagnitude(0, buffer.getNumSamples()) > SampleType(0))
+    {
+        //the filters were cleared on the way to sleep, so waking up starts them from silence
+        asleep = false;
+        silentSamples = 0;
+        return false;
+    }
+    
+    //while entering linear phase the recursive filters ring on behind the latency
+    auto tailLength = getTailLengthInSamples(linearPhase);
+    if (activePhaseMode == PhaseMode::enteringLinear)
+        tailLength = juce::jmax(tailLength, iirTailInSamples.load() + linearPhaseEQ.getLatencyInSamples());
     
+    if (! asleep && (double) silentSamples >= tailLength)
+    {
+        //what's left in the state is under tailThreshold anyway
+        asleep = true;
+        getPath<SampleType>().chainBank.reset();
+        getPath<SampleType>().svfBank.reset();
+        getPath<SampleType>().latencyHistory.clear();
+        linearPhaseEQ.reset();
+        snapBandMix = true;
+        
+        //a cleared FIR has heard exactly the silence that went in, it can take over straight away
+        if (activePhaseMode == PhaseMode::enteringLinear && linearPhaseSamplesHeard >= 0)
+            activePhaseMode = PhaseMode::linear;
+    }
+    
+    silentSamples += buffer.getNumSamples();
+    return asleep;
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::recordLatencyHistory(const juce::AudioBuffer<SampleType>& buffer)
+{
+    auto& path = getPath<SampleType>();
+    auto& history = path.latencyHistory;
+    const auto historyLength = history.getNumSamples();
+    const auto numChannels = juce::jmin(buffer.getNumChannels(), history.getNumChannels());
+    
+    if (historyLength == 0)
+        return;
+    
+    //only the last historyLength samples of a longer block matter
+    const auto numSamples = juce::jmin(buffer.getNumSamples(), historyLength);
+    const auto source = buffer.getNumSamples() - numSamples;
+    const auto first = juce::jmin(numSamples, historyLength - path.historyPosition);
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        history.copyFrom(channel, path.historyPosition, buffer, channel, source, first);
+        history.copyFrom(channel, 0, buffer, channel, source + first, numSamples - first);
+    }
+    
+    path.historyPosition = (path.historyPosition + numSamples) % historyLength;
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processLinearPhaseEntry(juce::AudioBuffer<SampleType>& buffer, PhaseMode previousPhaseMode)
+{
+    auto& path = getPath<SampleType>();
+    auto& history = path.latencyHistory;
+    auto& firBuffer = path.modeSwitchBuffer;
+    
+    const auto historyLength = history.getNumSamples();
+    const auto numChannels = juce::jmin(buffer.getNumChannels(), history.getNumChannels(), firBuffer.getNumChannels());
+    const auto numSamples = buffer.getNumSamples();
+    const auto maxChunk = firBuffer.getNumSamples();
+    
+    //the FIR's output is complete once it has heard a whole kernel, by then the fade into it is over
+    const auto firFadeLength = (double) (LinearPhaseEQ::getKernelLength(getSampleRate()) / 2);
+    
+    //a switch itself crossfades over this block, from the undelayed recursive output or back to it
+    const bool fadeIntoDelay = previousPhaseMode == PhaseMode::recursive;
+    const bool fadeOutOfDelay = activePhaseMode == PhaseMode::recursive;
+    
+    //nothing to delay through or chunk into, prepareToPlay hasn't run for this path. the EQ still plays, undelayed
+    if (maxChunk == 0 || historyLength == 0)
+    {
+        jassertfalse;
+        auto block = juce::dsp::AudioBlock<SampleType>(buffer);
+        processFilters(block, false);
+        
+        if (fadeOutOfDelay)
+            linearPhaseSamplesHeard = -1;
+        
+        return;
+    }
+    
+    //switched on during an offline render: wait for the FIR, it takes over at the same sample on every run
+    if (activePhaseMode == PhaseMode::enteringLinear && linearPhaseSamplesHeard < 0 && isNonRealtime())
+        linearPhaseEQ.buildNow();
+    
+    if (activePhaseMode == PhaseMode::enteringLinear && linearPhaseSamplesHeard < 0 && linearPhaseEQ.isReady())
+    {
+        linearPhaseEQ.reset();
+        linearPhaseSamplesHeard = 0;
+    }
+    
+    const bool firRunning = linearPhaseSamplesHeard >= 0;
+    
+    for (int start = 0; start < numSamples; start += maxChunk)
+    {
+        const auto chunk = juce::jmin(maxChunk, numSamples - start);
+        
+        if (firRunning)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                firBuffer.copyFrom(channel, 0, buffer, channel, start, chunk);
+            
+            auto firBlock = juce::dsp::AudioBlock<SampleType>(firBuffer).getSubsetChannelBlock(0, (size_t) numChannels)
+                                                                         .getSubBlock(0, (size_t) chunk);
+            processLinearPhase(firBlock);
+        }
+        
+        auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubBlock((size_t) start, (size_t) chunk);
+        processFilters(block, false);
+        
+        //the history is a delay line of exactly the latency, the recursive output goes in as the delayed one comes out
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* samples = buffer.getWritePointer(channel, start);
+            auto* delayed = history.getWritePointer(channel);
+            const auto* fir = firBuffer.getReadPointer(channel);
+            auto position = path.historyPosition;
+            
+            for (int i = 0; i < chunk; ++i)
+            {
+                const auto recursive = samples[i];
+                auto output = delayed[position];
+                delayed[position] = recursive;
+                
+                if (++position == historyLength)
+                    position = 0;
+                
+                if (firRunning)
+                {
+                    const auto heard = (double) (linearPhaseSamplesHeard + i + 1 - historyLength);
+                    output += (fir[i] - output) * (SampleType) juce::jlimit(0.0, 1.0, heard / firFadeLength);
+                }
+                
+                const auto switched = (SampleType) (start + i) / (SampleType) numSamples;
+                if (fadeIntoDelay)
+                    output = recursive + (output - recursive) * switched;
+                else if (fadeOutOfDelay)
+                    output += (recursive - output) * switched;
+                
+                samples[i] = output;
+            }
+        }
+        
+        path.historyPosition = (path.historyPosition + chunk) % historyLength;
+        
+        if (firRunning)
+            linearPhaseSamplesHeard += chunk;
+    }
+    
+    if (fadeOutOfDelay)
+        linearPhaseSamplesHeard = -1;
+    else if (firRunning && (double) (linearPhaseSamplesHeard - historyLength) >= firFadeLength)
+        activePhaseMode = PhaseMode::linear;
+}
+
+void SimpleEQAudioProcessor::processLinearPhase(juce::dsp::AudioBlock<float>& block)
+{
+    linearPhaseEQ.process(block);
+}
+
+void SimpleEQAudioProcessor::processLinearPhase(juce::dsp::AudioBlock<double>& block)
+{
+    //a FIR has no feedback for rounding errors to build up in, so float taps are plenty. the block is converted in and out
+    const auto numChannels = juce::jmin(block.getNumChannels(), (size_t) linearPhaseBuffer.getNumChannels());
+    const auto maxChunk = (size_t) linearPhaseBuffer.getNumSamples();
+    
+    for (size_t start = 0; start < block.getNumSamples() && maxChunk > 0; start += maxChunk)
+    {
+        const auto numSamples = juce::jmin(maxChunk, block.getNumSamples() - start);
+        
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* source = block.getChannelPointer(ch) + start;
+            auto* converted = linearPhaseBuffer.getWritePointer((int) ch);
+            for (size_t i = 0; i < numSamples; ++i)
+                converted[i] = (float) source[i];
+        }
+        
+        auto floatBlock = juce::dsp::AudioBlock<float>(linearPhaseBuffer).getSubsetChannelBlock(0, numChannels).getSubBlock(0, numSamples);
+        linearPhaseEQ.process(floatBlock);
+        
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* converted = linearPhaseBuffer.getReadPointer((int) ch);
+            auto* destination = block.getChannelPointer(ch) + start;
+            for (size_t i = 0; i < numSamples; ++i)
+                destination[i] = (double) converted[i];
+        }
+    }
+}
+
+void SimpleEQAudioProcessor::markAllFiltersDirty()
+{
+    for (size_t i = 0; i < appliedVersions.size(); ++i)
+        appliedVersions[i] = parameterVersions[i].load() - 1;
+}
+
+void SimpleEQAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    if (parameterID == "Linear Phase")
+    {
+        linearPhaseEQ.setEnabled(newValue > 0.5f);
+        triggerAsyncUpdate(); //the latency changes with the mode
+        return;
+    }
+    
+    if (parameterID.startsWith("LowCut"))
+        ++parameterVersions[ChainPositions::LowCut];
+    else if (parameterID.startsWith("HighCut"))
+        ++parameterVersions[ChainPositions::HighCut];
+    else if (parameterID.startsWith("Peak"))
+        ++parameterVersions[ChainPositions::Peak];
+    
+    //the design thread follows along, it does nothing while linear phase is off
+    linearPhaseEQ.requestDesign();
+}
+
+void SimpleEQAudioProcessor::handleAsyncUpdate()
+{
+    setLatencySamples(isLinearPhaseOn() ? linearPhaseEQ.getLatencyInSamples() : 0);
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::createParameterLayout()
 {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
     
+    //hosts learn from the version hint which release a parameter first appeared in: 1 for the original set, 2 for the
+    //slopes under their new IDs and linear phase. juce::ParameterID only exists from JUCE 7 on
+    auto parameterID = [](const char* id, int versionHint)
+    {
+       #if JUCE_MAJOR_VERSION >= 7
+        return juce::ParameterID { id, versionHint };
+       #else
+        juce::ignoreUnused(versionHint);
+        return juce::String(id);
+       #endif
+    };
+    
     //layout slider to change lowcut frequency, highcut frequency and peak frequency ...
     
     //all have float data type for slider
     
-    layout.add(std::make_unique<juce::AudioParameterFloat>("LowCut Freq",
+    layout.add(std::make_unique<juce::AudioParameterFloat>(parameterID("LowCut Freq", 1),
                                                            "LowCut Freq",
                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20.f));//note default freq = 20 for low
     
-    layout.add(std::make_unique<juce::AudioParameterFloat>("HighCut Freq",
+    layout.add(std::make_unique<juce::AudioParameterFloat>(parameterID("HighCut Freq", 1),
                                                            "HighCut Freq",
                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20000.f));//note default freq = 20000 for high
     
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Freq",
+    layout.add(std::make_unique<juce::AudioParameterFloat>(parameterID("Peak Freq", 1),
                                                            "Peak Freq",
                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 750.f));//default freq for peak = 750
     
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Gain",
+    layout.add(std::make_unique<juce::AudioParameterFloat>(parameterID("Peak Gain", 1),
                                                            "Peak Gain",
                                                            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.0f));//default freq for gain = 0 dont want any default gain or cut
     
     //peak band quality control (Q) --> how tight or how wide the peak band
     
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Quality",
+    layout.add(std::make_unique<juce::AudioParameterFloat>(parameterID("Peak Quality", 1),
                                                            "Peak Quality",
                                                            juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
    
     juce::StringArray stringArray;
-    for(int i = 0; i < 4; ++i)
+    for(int i = Slope_12; i <= Slope_96; ++i)
     {
         juce::String str;
-        str << (12 + i*12); //i starts at 0 ==> 12 + 0, 12+12 = 24, 12+24 = 36 (four choices for filter)
+        str << (6 * getCutOrder(i)); //12, 24, 36, 48, then 72 and 96 for subsonic/anti-alias cleanup
         str << " db/Oct"; //decibels per octave (unit for slope/order)
         stringArray.add(str);
     }
     
-    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCut Slope", stringArray, 0));
-    layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", stringArray, 0));
+    //new IDs: growing the old 4 choice parameters would have moved the normalised value of every slope under existing
+    //host automation (48 dB/oct went from 1.0 to 0.6). saved state under the old IDs is migrated in setStateInformation,
+    //automation lanes and controller mappings bound to the old IDs are not and have to be reassigned
+    layout.add(std::make_unique<juce::AudioParameterChoice>(parameterID("LowCut Slope v2", 2), "LowCut Slope", stringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(parameterID("HighCut Slope v2", 2), "HighCut Slope", stringArray, 0));
+    
+    //same response, no phase shift, at the cost of LinearPhaseEQ::getLatencyInSamples() of delay
+    layout.add(std::make_unique<juce::AudioParameterBool>(parameterID("Linear Phase", 2), "Linear Phase", false));
     
     
     
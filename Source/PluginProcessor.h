@@ -9,71 +9,15 @@
 #pragma once
 
 #include <JuceHeader.h>
-
-//READ ABOUT FIFO AND ALGORITHM TO GENERATE SPECTRUM STUFF
-#include <array>
-template<typename T>
-struct Fifo
-{
-    void prepare(int numChannels, int numSamples)
-    {
-        static_assert( std::is_same_v<T, juce::AudioBuffer<float>>,
-                      "prepare(numChannels, numSamples) should only be used when the Fifo is holding juce::AudioBuffer<float>");
-        for( auto& buffer : buffers)
-        {
-            buffer.setSize(numChannels,
-                           numSamples,
-                           false,   //clear everything?
-                           true,    //including the extra space?
-                           true);   //avoid reallocating if you can?
-            buffer.clear();
-        }
-    }
-    
-    void prepare(size_t numElements)
-    {
-        static_assert( std::is_same_v<T, std::vector<float>>,
-                      "prepare(numElements) should only be used when the Fifo is holding std::vector<float>");
-        for( auto& buffer : buffers )
-        {
-            buffer.clear();
-            buffer.resize(numElements, 0);
-        }
-    }
-    
-    bool push(const T& t)
-    {
-        auto write = fifo.write(1);
-        if( write.blockSize1 > 0 )
-        {
-            buffers[write.startIndex1] = t;
-            return true;
-        }
-        
-        return false;
-    }
-    
-    bool pull(T& t)
-    {
-        auto read = fifo.read(1);
-        if( read.blockSize1 > 0 )
-        {
-            t = buffers[read.startIndex1];
-            return true;
-        }
-        
-        return false;
-    }
-    
-    int getNumAvailableForReading() const
-    {
-        return fifo.getNumReady();
-    }
-private:
-    static constexpr int Capacity = 30;
-    std::array<T, Capacity> buffers;
-    juce::AbstractFifo fifo {Capacity};
-};
+#include "CoefficientDesign.h"
+#include "CoefficientTables.h"
+#include "FusedCascade.h"
+#include "SVFCascade.h"
+#include "RealtimeSafety.h"
+#include "SampleRing.h"
+#include "FrequencyResponse.h"
+#include "Fifo.h"
+#include "LinearPhaseEQ.h"
 
 enum Channel
 {
@@ -81,78 +25,23 @@ enum Channel
     Left //effectively 1
 };
 
-template<typename BlockType>
-struct SingleChannelSampleFifo
-{
-    SingleChannelSampleFifo(Channel ch) : channelToUse(ch)
-    {
-        prepared.set(false);
-    }
-    
-    void update(const BlockType& buffer)
-    {
-        jassert(prepared.get());
-        jassert(buffer.getNumChannels() > channelToUse );
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
-        
-        for( int i = 0; i < buffer.getNumSamples(); ++i )
-        {
-            pushNextSampleIntoFifo(channelPtr[i]);
-        }
-    }
-
-    void prepare(int bufferSize)
-    {
-        prepared.set(false);
-        size.set(bufferSize);
-        
-        bufferToFill.setSize(1,             //channel
-                             bufferSize,    //num samples
-                             false,         //keepExistingContent
-                             true,          //clear extra space
-                             true);         //avoid reallocating
-        audioBufferFifo.prepare(1, bufferSize);
-        fifoIndex = 0;
-        prepared.set(true);
-    }
-    //==============================================================================
-    int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
-    bool isPrepared() const { return prepared.get(); }
-    int getSize() const { return size.get(); }
-    //==============================================================================
-    bool getAudioBuffer(BlockType& buf) { return audioBufferFifo.pull(buf); }
-private:
-    Channel channelToUse;
-    int fifoIndex = 0;
-    Fifo<BlockType> audioBufferFifo;
-    BlockType bufferToFill;
-    juce::Atomic<bool> prepared = false;
-    juce::Atomic<int> size = 0;
-    
-    void pushNextSampleIntoFifo(float sample)
-    {
-        if (fifoIndex == bufferToFill.getNumSamples())
-        {
-            auto ok = audioBufferFifo.push(bufferToFill);
-
-            juce::ignoreUnused(ok);
-            
-            fifoIndex = 0;
-        }
-        
-        bufferToFill.setSample(0, fifoIndex, sample);
-        ++fifoIndex;
-    }
-};
-
 enum Slope
 {
     Slope_12,
     Slope_24,
     Slope_36,
-    Slope_48
+    Slope_48,
+    Slope_72,
+    Slope_96
 };
 
+//butterworth order of a Slope choice, 6 dB/oct per order: 2, 4, 6, 8, 12, 16
+inline int getCutOrder(int slope)
+{
+    constexpr std::array<int, Slope_96 + 1> orders { 2, 4, 6, 8, 12, 16 };
+    return orders[(size_t) juce::jlimit(0, (int) Slope_96, slope)];
+}
+
 struct ChainSettings
 {
     float peakFreq {0}, peakGainInDecibels {0}, peakQuality {1.f};
@@ -162,11 +51,26 @@ struct ChainSettings
 
 ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
 
-using Filter = juce::dsp::IIR::Filter<float>; /*RESEARCH PROCESS CHAINS AND PROCESS CONTEXT*/
+//chain types are templated on the sample type so the same chain can run on SIMDRegister lanes
+template<typename SampleType>
+using FilterT = juce::dsp::IIR::Filter<SampleType>;
 
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+//one Filter per possible cut section (maxCutSections), generated so the chain follows the steepest Slope
+template<typename SampleType, size_t... Stages>
+juce::dsp::ProcessorChain<std::conditional_t<true, FilterT<SampleType>, std::integral_constant<size_t, Stages>>...>
+    makeCutFilterChain(std::index_sequence<Stages...>);
 
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+template<typename SampleType>
+using CutFilterT = decltype(makeCutFilterChain<SampleType>(std::make_index_sequence<maxCutSections>()));
+
+template<typename SampleType>
+using MonoChainT = juce::dsp::ProcessorChain<CutFilterT<SampleType>, FilterT<SampleType>, CutFilterT<SampleType>>;
+
+using Filter = FilterT<float>; /*RESEARCH PROCESS CHAINS AND PROCESS CONTEXT*/
+
+using CutFilter = CutFilterT<float>;
+
+using MonoChain = MonoChainT<float>;
 
 enum ChainPositions
 {
@@ -175,10 +79,175 @@ enum ChainPositions
     HighCut
 };
 
+/**
+ ramps ChainSettings towards the latest parameter values so fast automation doesn't zipper.
+ frequencies and Q ramp multiplicatively, the gain linearly in dB, slopes jump straight to the new value.
+ */
+struct SmoothedChainSettings
+{
+    void reset(double sampleRate, double rampLengthInSeconds, const ChainSettings& settings)
+    {
+        lowCutFreq.reset(sampleRate, rampLengthInSeconds);
+        highCutFreq.reset(sampleRate, rampLengthInSeconds);
+        peakFreq.reset(sampleRate, rampLengthInSeconds);
+        peakQuality.reset(sampleRate, rampLengthInSeconds);
+        peakGainInDecibels.reset(sampleRate, rampLengthInSeconds);
+        
+        lowCutFreq.setCurrentAndTargetValue(settings.lowCutFreq);
+        highCutFreq.setCurrentAndTargetValue(settings.highCutFreq);
+        peakFreq.setCurrentAndTargetValue(settings.peakFreq);
+        peakQuality.setCurrentAndTargetValue(settings.peakQuality);
+        peakGainInDecibels.setCurrentAndTargetValue(settings.peakGainInDecibels);
+        lowCutSlope = settings.lowCutSlope;
+        highCutSlope = settings.highCutSlope;
+    }
+    
+    void setTarget(const ChainSettings& settings)
+    {
+        lowCutFreq.setTargetValue(settings.lowCutFreq);
+        highCutFreq.setTargetValue(settings.highCutFreq);
+        peakFreq.setTargetValue(settings.peakFreq);
+        peakQuality.setTargetValue(settings.peakQuality);
+        peakGainInDecibels.setTargetValue(settings.peakGainInDecibels);
+        lowCutSlope = settings.lowCutSlope;
+        highCutSlope = settings.highCutSlope;
+    }
+    
+    bool isSmoothing(ChainPositions group) const
+    {
+        switch (group)
+        {
+            case LowCut:  return lowCutFreq.isSmoothing();
+            case HighCut: return highCutFreq.isSmoothing();
+            case Peak:    return peakFreq.isSmoothing() || peakQuality.isSmoothing() || peakGainInDecibels.isSmoothing();
+        }
+        
+        return false;
+    }
+    
+    //jumps every ramp to where it's heading, e.g. when nothing has been processing along it
+    void snapToTargets()
+    {
+        lowCutFreq.setCurrentAndTargetValue(lowCutFreq.getTargetValue());
+        highCutFreq.setCurrentAndTargetValue(highCutFreq.getTargetValue());
+        peakFreq.setCurrentAndTargetValue(peakFreq.getTargetValue());
+        peakQuality.setCurrentAndTargetValue(peakQuality.getTargetValue());
+        peakGainInDecibels.setCurrentAndTargetValue(peakGainInDecibels.getTargetValue());
+    }
+    
+    /**
+     the per sample version of skip() for SVFBank: each frequency ramp that is moving writes its next numSamples values
+     to its array in 'frequencies' (ChainPositions order) and sets its flag in 'written'. Q and gain move once for the span.
+     */
+    ChainSettings skipPerSample(int numSamples, const std::array<float*, 3>& frequencies, std::array<bool, 3>& written)
+    {
+        auto fill = [numSamples](auto& ramp, float* destination)
+        {
+            if (! ramp.isSmoothing())
+                return false;
+            
+            for (int i = 0; i < numSamples; ++i)
+                destination[i] = ramp.getNextValue();
+            
+            return true;
+        };
+        
+        written[LowCut] = fill(lowCutFreq, frequencies[LowCut]);
+        written[Peak] = fill(peakFreq, frequencies[Peak]);
+        written[HighCut] = fill(highCutFreq, frequencies[HighCut]);
+        
+        ChainSettings settings;
+        settings.lowCutFreq = lowCutFreq.getCurrentValue();
+        settings.highCutFreq = highCutFreq.getCurrentValue();
+        settings.peakFreq = peakFreq.getCurrentValue();
+        settings.peakQuality = peakQuality.skip(numSamples);
+        settings.peakGainInDecibels = peakGainInDecibels.skip(numSamples);
+        settings.lowCutSlope = lowCutSlope;
+        settings.highCutSlope = highCutSlope;
+        return settings;
+    }
+    
+    //moves every ramp on by numSamples and returns where they ended up
+    ChainSettings skip(int numSamples)
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = lowCutFreq.skip(numSamples);
+        settings.highCutFreq = highCutFreq.skip(numSamples);
+        settings.peakFreq = peakFreq.skip(numSamples);
+        settings.peakQuality = peakQuality.skip(numSamples);
+        settings.peakGainInDecibels = peakGainInDecibels.skip(numSamples);
+        settings.lowCutSlope = lowCutSlope;
+        settings.highCutSlope = highCutSlope;
+        return settings;
+    }
+    
+private:
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> lowCutFreq, highCutFreq, peakFreq, peakQuality;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> peakGainInDecibels;
+    int lowCutSlope {Slope::Slope_12}, highCutSlope {Slope::Slope_12};
+};
+
 using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+template<typename NumericType>
+using CoefficientsPtrT = juce::ReferenceCountedObjectPtr<juce::dsp::IIR::Coefficients<NumericType>>;
+
+template<typename NumericType>
+void updateCoefficients(CoefficientsPtrT<NumericType>& old, const CoefficientsPtrT<NumericType>& replacements)
+{
+    *old = *replacements;
+}
+
+template<typename NumericType>
+void updateCoefficients(CoefficientsPtrT<NumericType>& old, const BiquadCoefficients<NumericType>& replacements) //in place, no allocation
+{
+    CoefficientDesign::copyInto(*old, replacements);
+}
+
+template<typename NumericType = float>
+CoefficientsPtrT<NumericType> makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::IIR::Coefficients<NumericType>::makePeakFilter(sampleRate,
+                                                                     chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(NumericType(chainSettings.peakGainInDecibels)));
+}
+
+//allocation-free counterparts of makePeakFilter/makeLowCutFilter/makeHighCutFilter, safe to call from processBlock.
+//float and double are instantiated in PluginProcessor.cpp
+template<typename NumericType>
+void designPeakFilter(BiquadCoefficients<NumericType>& peakCoefficients, const ChainSettings& chainSettings, double sampleRate);
+template<typename NumericType>
+void designLowCutFilter(CutCoefficients<NumericType>& cutCoefficients, const ChainSettings& chainSettings, double sampleRate);
+template<typename NumericType>
+void designHighCutFilter(CutCoefficients<NumericType>& cutCoefficients, const ChainSettings& chainSettings, double sampleRate);
+
+//every section of the EQ at once, e.g. for drawing or measuring the response
+template<typename NumericType = float>
+CascadeCoefficients<NumericType> designCascade(const ChainSettings& chainSettings, double sampleRate);
+
+//how far from 0 dB one band gets between 20 Hz and 20 kHz (or just below Nyquist), worked out from the settings without
+//designing anything. a cut at the end of its range is still 3 dB down at the edge, so it only counts as flat with a loose tolerance
+float getBandDeviationInDecibels(ChainPositions band, const ChainSettings& chainSettings, double sampleRate);
+
+template<typename CutChainType, typename Function, size_t... Stages>
+void forEachCutStage(CutChainType& cut, Function&& function, std::index_sequence<Stages...>)
+{
+    (function(cut.template get<Stages>()), ...);
+}
+
+//Filter's default coefficients are first order, give every filter biquad storage up front so updates never reallocate
+template<typename ChainType>
+void prepareCoefficientStorage(ChainType& chain)
+{
+    auto makeBiquadStorage = [](auto& filter)
+    {
+        using NumericType = typename std::decay_t<decltype(filter)>::NumericType;
+        filter.coefficients = new juce::dsp::IIR::Coefficients<NumericType>(1, 0, 0, 1, 0, 0);
+    };
+    
+    forEachCutStage(chain.template get<ChainPositions::LowCut>(), makeBiquadStorage, std::make_index_sequence<maxCutSections>());
+    makeBiquadStorage(chain.template get<ChainPositions::Peak>());
+    forEachCutStage(chain.template get<ChainPositions::HighCut>(), makeBiquadStorage, std::make_index_sequence<maxCutSections>());
+}
 
 //refactoring the switch cases for getCoefficients... (now commented)
 template<int Index, typename ChainType, typename CoefficientType>
@@ -188,6 +257,14 @@ void update(ChainType& chain, const CoefficientType& coefficients)
     chain.template setBypassed<Index>(false);
 }
 
+//the first numSections stages take the new sections, every stage past the slope is bypassed
+template<typename ChainType, typename CoefficientType, size_t... Stages>
+void updateCutStages(ChainType& cut, const CoefficientType& cutCoefficients, int numSections, std::index_sequence<Stages...>)
+{
+    (((int) Stages < numSections ? update<(int) Stages>(cut, cutCoefficients)
+                                 : cut.template setBypassed<Stages>(true)), ...);
+}
+
 template<typename ChainType, typename CoefficientType>
 void updateLowCutFilter(ChainType& leftLowCut,
                      const CoefficientType& cutCoefficients,
@@ -201,35 +278,8 @@ void updateLowCutFilter(ChainType& leftLowCut,
 //        //LOWCUT DSP
 //        auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
     
-    //bypass all the links in the chain, 4 positions -> 4 bypass
-    
-    leftLowCut.template setBypassed<0>(true);
-    leftLowCut.template setBypassed<1>(true);
-    leftLowCut.template setBypassed<2>(true);
-    leftLowCut.template setBypassed<3>(true);
-    
-    switch(chainSettings.lowCutSlope)
-    {
-        case Slope_48:
-        {
-            update<3>(leftLowCut, cutCoefficients);
-        }
-        
-        case Slope_36:
-        {
-            update<2>(leftLowCut, cutCoefficients);
-        }
-        
-        case Slope_24:
-        {
-            update<1>(leftLowCut, cutCoefficients);
-        }
-            
-        case Slope_12:
-        {
-            update<0>(leftLowCut, cutCoefficients);
-        }
-    }
+    //was a fall-through switch over the slopes, one case per stage
+    updateCutStages(leftLowCut, cutCoefficients, getCutOrder(chainSettings.lowCutSlope) / 2, std::make_index_sequence<maxCutSections>());
 }
 
 /*
@@ -282,50 +332,156 @@ void updateHighCutFilter(ChainType& leftHighCut,
                      const ChainSettings& chainSettings)
                      //const Slope& lowCutSlope) IDKY DOES NOT WORK :(
 {
+    updateCutStages(leftHighCut, cutCoefficients, getCutOrder(chainSettings.highCutSlope) / 2, std::make_index_sequence<maxCutSections>());
+}
+
+/**
+ runs the EQ cascade over up to SIMDRegister<SampleType>::size() channels at once (4 floats or 2 doubles with SSE/NEON).
+ each channel is interleaved into one lane of a SIMDRegister, so one fused sweep of the cascade filters all of them.
+ */
+template<typename SampleType>
+struct SIMDChainGroupT
+{
+    using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr size_t numLanes = SIMDType::SIMDNumElements;
     
-    leftHighCut.template setBypassed<0>(true);
-    leftHighCut.template setBypassed<1>(true);
-    leftHighCut.template setBypassed<2>(true);
-    leftHighCut.template setBypassed<3>(true);
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        cascade.reset();
+        
+        interleaved = juce::dsp::AudioBlock<SIMDType>(interleavedData, 1, spec.maximumBlockSize);
+        
+        //lanes without a channel stay silent, so zero them once here and the filters keep them at zero
+        auto* lanes = reinterpret_cast<SampleType*>(interleaved.getChannelPointer(0));
+        std::fill(lanes, lanes + interleaved.getNumSamples() * numLanes, SampleType(0));
+    }
     
-    switch(chainSettings.highCutSlope)
+    //'channels' must not hold more than numLanes channels
+    void process(const CascadeCoefficients<SampleType>& coefficients, const juce::dsp::AudioBlock<SampleType>& channels)
     {
-        case Slope_48:
-        {
-            update<3>(leftHighCut, cutCoefficients);
-        }
+        const auto numChannels = channels.getNumChannels();
+        const auto maxChunk = interleaved.getNumSamples();
+        jassert(numChannels <= numLanes);
         
-        case Slope_36:
+        //hosts occasionally send more than maximumBlockSize, work through it in chunks
+        for (size_t start = 0; start < channels.getNumSamples(); start += maxChunk)
         {
-            update<2>(leftHighCut, cutCoefficients);
+            const auto numSamples = juce::jmin(maxChunk, channels.getNumSamples() - start);
+            auto* lanes = reinterpret_cast<SampleType*>(interleaved.getChannelPointer(0));
+            
+            for (size_t ch = 0; ch < numChannels; ++ch)
+            {
+                auto* src = channels.getChannelPointer(ch) + start;
+                for (size_t i = 0; i < numSamples; ++i)
+                    lanes[i * numLanes + ch] = src[i];
+            }
+            
+            cascade.process(coefficients, interleaved.getChannelPointer(0), numSamples);
+            
+            for (size_t ch = 0; ch < numChannels; ++ch)
+            {
+                auto* dest = channels.getChannelPointer(ch) + start;
+                for (size_t i = 0; i < numSamples; ++i)
+                    dest[i] = lanes[i * numLanes + ch];
+            }
         }
+    }
+    
+    //forgets the filter state, e.g. when the bank hasn't run for a while
+    void reset() { cascade.reset(); }
+    void resetSlots(int firstSlot, int numSlots) { cascade.resetSlots(firstSlot, numSlots); }
+    
+private:
+    FusedBiquadCascade<SIMDType> cascade;
+    
+    juce::HeapBlock<char> interleavedData;
+    juce::dsp::AudioBlock<SIMDType> interleaved;
+};
+
+using SIMDChainGroup = SIMDChainGroupT<float>;
+
+/**
+ filters every channel of the bus (mono, stereo, 7.1.4, 3rd order ambisonics...) with one shared coefficient set.
+ sized from the bus layout in prepareToPlay, channels are processed in SIMD-width groups.
+ coefficients and state are SampleType too, so a double bank keeps double precision all the way through the feedback.
+ */
+template<typename SampleType>
+struct ChainBankT
+{
+    static constexpr size_t numLanes = SIMDChainGroupT<SampleType>::numLanes;
+    
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        numChannels = spec.numChannels;
         
-        case Slope_24:
-        {
-            update<1>(leftHighCut, cutCoefficients);
-        }
-            
-        case Slope_12:
+        groups.clear();
+        groups.resize((numChannels + numLanes - 1) / numLanes);
+        
+        for (auto& group : groups)
+            group.prepare(spec);
+    }
+    
+    void process(const juce::dsp::AudioBlock<SampleType>& block)
+    {
+        //every band bypassed: not even the interleaving is left to do
+        if (coefficients.getNumActiveSections() == 0)
+            return;
+        
+        const auto channelsToProcess = juce::jmin(block.getNumChannels(), numChannels);
+        
+        for (size_t first = 0, g = 0; first < channelsToProcess; first += numLanes, ++g)
         {
-            update<0>(leftHighCut, cutCoefficients);
+            auto groupChannels = juce::jmin(numLanes, channelsToProcess - first);
+            groups[g].process(coefficients, block.getSubsetChannelBlock(first, groupChannels));
         }
     }
-}
+    
+    void reset()
+    {
+        for (auto& group : groups)
+            group.reset();
+    }
+    
+    void setLowCut(const CutCoefficients<SampleType>& lowCut)   { coefficients.setLowCut(lowCut); }
+    void setPeak(const BiquadCoefficients<SampleType>& peak)      { coefficients.setPeak(peak); }
+    void setHighCut(const CutCoefficients<SampleType>& highCut) { coefficients.setHighCut(highCut); }
+    
+    //see CascadeCoefficients::setBandMix. a band coming back from 0 starts from silence, not from the state it was dropped with
+    void setBandMix(int band, SampleType mix)
+    {
+        if (coefficients.getBandMix(band) <= SampleType(0) && mix > SampleType(0))
+            for (auto& group : groups)
+                group.resetSlots(CascadeCoefficients<SampleType>::getFirstSlot(band), CascadeCoefficients<SampleType>::getNumBandSlots(band));
+        
+        coefficients.setBandMix(band, mix);
+    }
+    
+private:
+    CascadeCoefficients<SampleType> coefficients;
+    std::vector<SIMDChainGroupT<SampleType>> groups;
+    size_t numChannels = 0;
+};
+
+using ChainBank = ChainBankT<float>;
 
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+template<typename NumericType = float>
+auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
 {
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, 2*(chainSettings.lowCutSlope+1));
+    return juce::dsp::FilterDesign<NumericType>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, getCutOrder(chainSettings.lowCutSlope));
 }
 
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+template<typename NumericType = float>
+auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
 {
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, 2*(chainSettings.highCutSlope+1));
+    return juce::dsp::FilterDesign<NumericType>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, getCutOrder(chainSettings.highCutSlope));
 }
 
 //==============================================================================
 /**
 */
-class SimpleEQAudioProcessor  : public juce::AudioProcessor
+class SimpleEQAudioProcessor  : public juce::AudioProcessor,
+                                juce::AudioProcessorValueTreeState::Listener,
+                                juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -341,6 +497,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override; //called when hit the play button
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override; //64 bit hosts, the IIR path runs in double throughout
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -365,25 +523,190 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
     
+    //bumps the version of the parameter group (low cut, peak, high cut) the parameter belongs to, or switches the phase mode
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    
+    /**
+     0 keeps the block-rate path. otherwise parameter changes ramp over smoothingRampSeconds and the
+     coefficients are only redesigned every 'numSamples' samples (clamped to 8..64): smaller is smoother, larger is cheaper.
+     */
+    void setSmoothingSubBlockSize(int numSamples) { smoothingSubBlockSize = numSamples > 0 ? juce::jlimit(8, 64, numSamples) : 0; }
+    int getSmoothingSubBlockSize() const { return smoothingSubBlockSize; }
+    static constexpr double smoothingRampSeconds = 0.05;
+    
+    /**
+     magnitude response in dB (floored at -100 dB) of the current parameter settings at each of 'frequencies' (Hz), at the
+     sample rate the processor was prepared with (44.1 kHz before that). designs and evaluates on the calling thread and
+     allocates, so call it from anywhere but the audio thread.
+     */
+    void getFrequencyResponse(const double* frequencies, double* magnitudesInDecibels, int numFrequencies);
+    
+    //designs coefficients from a per sample rate lookup table instead of calling tan/sin/cos. takes effect on the next prepareToPlay
+    void setUseCoefficientTables(bool shouldUseTables) { useCoefficientTables = shouldUseTables; }
+    bool isUsingCoefficientTables() const { return useCoefficientTables; }
+    
+    /**
+     biquads (the default), or TPT state variable filters (SVFBank) with the same response whose frequencies follow the
+     parameters every sample over smoothingRampSeconds, for audio rate sweeps. takes effect on the next prepareToPlay.
+     */
+    enum class FilterTopology { biquad, stateVariable };
+    void setFilterTopology(FilterTopology newTopology) { filterTopology = newTopology; }
+    FilterTopology getFilterTopology() const { return filterTopology; }
+    
+    /**
+     a band that stays within this many dB of flat across the audible range (getBandDeviationInDecibels) is taken out of
+     the biquad cascade and costs nothing, it fades out and back in over bypassRampSeconds. negative keeps every band running.
+     any thread, every band is checked again on the next block.
+     */
+    void setBypassTolerance(float decibels)
+    {
+        bypassTolerance = decibels;
+        for (auto& version : parameterVersions)
+            ++version;
+    }
+    float getBypassTolerance() const { return bypassTolerance; }
+    static constexpr double bypassRampSeconds = 0.01;
+    
+    //designCascade() without the bands the bypass tolerance takes out, i.e. what processBlock runs once any fade is over
+    CascadeCoefficients<float> designActiveCascade(const ChainSettings& chainSettings, double sampleRate) const;
+    
+    /**
+     once the input has been digital silence (exact zeros) for longer than the tail (getTailLengthSeconds), the filters are
+     cleared and processBlock only clears the buffer, until a block with any non-zero sample comes in. quiet input, however
+     far below tailThreshold, is always filtered. on by default, any thread.
+     */
+    void setSleepEnabled(bool shouldSleep) { sleepEnabled = shouldSleep; }
+    bool isSleepEnabled() const { return sleepEnabled; }
+    static constexpr double tailThreshold = 1.0e-6; //-120 dB: where the filters' decay counts as over
+    
+    /**
+     FilterTopology::stateVariable on a stereo bus: a block whose left and right are bit-identical, going into filters
+     whose left and right state is identical too, only filters the left channel and copies it over (the right state is
+     kept in step). the check stops at the first differing sample. on by default, any thread. the biquads already filter
+     both channels in one SIMD register and linear phase a channel pair in one FFT, neither would do less work.
+     */
+    void setDualMonoDetection(bool shouldDetect) { dualMonoDetection = shouldDetect; }
+    bool isDualMonoDetectionOn() const { return dualMonoDetection; }
+    
     
     //audio plugins use parameters. need public variable in our processor for linking with GUI
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts{*this, nullptr, "Parameters", createParameterLayout()};
     
-    using BlockType = juce::AudioBuffer<float>;
-    SingleChannelSampleFifo<BlockType> leftChannelFifo {Channel::Left};
-    SingleChannelSampleFifo<BlockType> rightChannelFifo {Channel::Right};
+    //the analyzer's tap on the output, one ring channel per Channel (Right = bus channel 0, Left = bus channel 1)
+    SampleRing analyzerRing;
+    static constexpr int analyzerHistorySize = 1 << 13; //the longest FFT the editor can run (FFTOrder::order8192)
+    
+    //analyzers register while they're on screen, with none processBlock doesn't feed the ring at all
+    void addAnalyzerClient() { ++numAnalyzerClients; }
+    void removeAnalyzerClient() { --numAnalyzerClients; }
     
 private:
     //making namespace aliases because juce::dsp:: uses lots of namespaces and nested namespaces... now in public up
-    MonoChain leftChain, rightChain;
+    /**
+     everything processBlock touches that depends on the host's sample type. there is one for float and one for double,
+     only the one matching isUsingDoublePrecision() is designed into, the host switches precision through prepareToPlay.
+     */
+    template<typename SampleType>
+    struct ProcessingPath
+    {
+        //every channel of the bus, processed in SIMD-width groups with one shared coefficient set
+        ChainBankT<SampleType> chainBank;
+        SVFBank<SampleType> svfBank; //FilterTopology::stateVariable
+        
+        //preallocated storage the design functions write into on the audio thread
+        BiquadCoefficients<SampleType> peakCoefficients;
+        CutCoefficients<SampleType> lowCutCoefficients, highCutCoefficients;
+        
+        juce::AudioBuffer<SampleType> modeSwitchBuffer; //a copy of the block for the mode being switched to, the two are crossfaded
+        
+        //the last latency's worth of output, replayed while the FIR catches up after a switch into linear phase
+        juce::AudioBuffer<SampleType> latencyHistory;
+        int historyPosition = 0;
+    };
+    
+    ProcessingPath<float> floatPath;
+    ProcessingPath<double> doublePath;
+    
+    template<typename SampleType>
+    ProcessingPath<SampleType>& getPath()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doublePath;
+        else
+            return floatPath;
+    }
+    
+    template<typename SampleType> void processSamples(juce::AudioBuffer<SampleType>& buffer);
+    
+    template<typename SampleType> void updatePeakFilter(const ChainSettings& chainSettings); //peak filter updating refactoring
+    
+    template<typename SampleType> void lowCutFiltersImplemented(const ChainSettings& chainSettings);
+    template<typename SampleType> void highCutFiltersImplemented(const ChainSettings& chainSettings);
+    
+    template<typename SampleType> void updateFilters();
+    void markAllFiltersDirty();
+    template<typename SampleType> void applyChainSettings(const ChainSettings& chainSettings, const std::array<bool, 3>& groupsToUpdate);
+    template<typename SampleType> void processSmoothed(juce::dsp::AudioBlock<SampleType>& block, int subBlockSize);
+    template<typename SampleType> void processStateVariable(juce::dsp::AudioBlock<SampleType>& block);
+    template<typename SampleType> void processChainBank(const juce::dsp::AudioBlock<SampleType>& block);
+    
+    //one version per ChainPositions group. parameterChanged bumps them, updateFilters only redesigns the groups whose version moved
+    std::array<std::atomic<unsigned int>, 3> parameterVersions {};
+    std::array<unsigned int, 3> appliedVersions {};
+    
+    std::atomic<int> smoothingSubBlockSize {0};
+    int activeSubBlockSize = 0; //what the audio thread last ran with, to catch the mode being switched
+    SmoothedChainSettings smoothedSettings;
+    std::array<bool, 3> pendingSmoothedDesign {}; //groups that changed without ramping (slopes) and still need a redesign
+    
+    std::atomic<FilterTopology> filterTopology {FilterTopology::biquad};
+    FilterTopology activeTopology = FilterTopology::biquad; //latched in prepareToPlay
+    std::array<std::vector<float>, 3> frequencyRamps; //per sample frequencies for the SVF path, ChainPositions order
+    
+    std::atomic<bool> sleepEnabled {true};
+    std::atomic<double> iirTailInSamples {0.0}; //what runs in the active topology, read by getTailLengthSeconds on any thread
+    std::array<double, 3> bandTailInSamples {}; //per group as last designed, ChainPositions order
+    void updateTailLength();
+    juce::int64 silentSamples = 0; //zero input samples in a row
+    bool asleep = false;
+    template<typename SampleType> bool updateSleep(const juce::AudioBuffer<SampleType>& buffer, bool linearPhase);
+    double getTailLengthInSamples(bool linearPhase) const;
+    
+    std::atomic<float> bypassTolerance {0.05f};
+    std::array<bool, 3> bandBypassed {}; //from each band's last design, ChainPositions order
+    std::array<float, 3> bandMix {1.f, 1.f, 1.f}; //how far each band is faded in, as last given to the chain bank
+    bool snapBandMix = true; //after a reset the bands start where they should be instead of fading
+    static constexpr size_t bypassRampStepSize = 32; //samples between band mix updates while one is fading
+    
+    std::atomic<bool> useCoefficientTables {false};
+    std::shared_ptr<const CoefficientTable> coefficientTable; //shared with every other instance at the same sample rate, null unless enabled
     
-    void updatePeakFilter(const ChainSettings& chainSettings); //peak filter updating refactoring
+    std::atomic<int> numAnalyzerClients {0};
     
-    void lowCutFiltersImplemented(const ChainSettings& chainSettings);
-    void highCutFiltersImplemented(const ChainSettings& chainSettings);
+    //"Linear Phase": the same magnitude response as a symmetric FIR, latency reported while it's on
+    LinearPhaseEQ linearPhaseEQ { [this](double sampleRate) { return designActiveCascade(getChainSettings(apvts), sampleRate); } };
+    std::atomic<float>* linearPhaseParameter = nullptr;
+    /**
+     a FIR that has just started has no history, its first latency's worth of output would be silence. entering linear
+     phase the recursive filters keep playing, delayed by the latency through latencyHistory, until the FIR has heard a
+     kernel's worth of input, and fade into it on the way.
+     */
+    enum class PhaseMode { recursive, enteringLinear, linear };
+    PhaseMode activePhaseMode = PhaseMode::recursive; //the mode processBlock last ran in
+    juce::int64 linearPhaseSamplesHeard = -1; //input the FIR has run on since entering, -1 until it's built
+    juce::AudioBuffer<float> linearPhaseBuffer; //the double path converts through here, the FIR itself runs in float
     
-    void updateFilters();
+    template<typename SampleType> void processFilters(juce::dsp::AudioBlock<SampleType>& block, bool linearPhase);
+    template<typename SampleType> void processRecursive(juce::dsp::AudioBlock<SampleType>& block);
+    template<typename SampleType> bool isDualMono(const juce::dsp::AudioBlock<SampleType>& block);
+    template<typename SampleType> void recordLatencyHistory(const juce::AudioBuffer<SampleType>& buffer);
+    template<typename SampleType> void processLinearPhaseEntry(juce::AudioBuffer<SampleType>& buffer, PhaseMode previousPhaseMode);
+    std::atomic<bool> dualMonoDetection {true};
+    void processLinearPhase(juce::dsp::AudioBlock<float>& block);
+    void processLinearPhase(juce::dsp::AudioBlock<double>& block);
+    bool isLinearPhaseOn() const { return linearPhaseParameter->load() > 0.5f; }
+    void handleAsyncUpdate() override; //message thread: tells the host the latency of the current mode
     
     juce::dsp::Oscillator<float> osc; //test oscillator to verify FFT accuracy
     
@@ -0,0 +1,539 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.cpp
+
+  ==============================================================================
+*/
+
+#include "RealtimeSafety.h"
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #include <dlfcn.h>
+ #include <pthread.h>
+#endif
+
+#if JUCE_GCC || JUCE_CLANG
+ #include <cxxabi.h>
+#endif
+
+#if JUCE_MSVC
+ #include <intrin.h>
+ #define SIMPLEEQ_RETURN_ADDRESS _ReturnAddress()
+#else
+ #define SIMPLEEQ_RETURN_ADDRESS __builtin_return_address(0)
+#endif
+
+namespace RealtimeSafety
+{
+    namespace
+    {
+        //namespace scope with constant initialisation, so nothing here needs a guarded static the interceptors could recurse into
+        EventLog eventLog;
+        //read by the malloc hook: a dynamic TLS model would allocate on a thread's first access from a loaded plugin
+       #if JUCE_GCC || JUCE_CLANG
+        __attribute__((tls_model("initial-exec")))
+       #endif
+        thread_local int realtimeDepth = 0;
+
+        const char* getTypeName(EventType type)
+        {
+            switch (type)
+            {
+                case EventType::allocation:   return "allocation";
+                case EventType::deallocation: return "deallocation";
+                case EventType::lock:         return "lock";
+            }
+
+            return "";
+        }
+
+        juce::String describeCallSite(const void* callSite)
+        {
+            auto address = "0x" + juce::String::toHexString((juce::pointer_sized_int) callSite);
+
+           #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+            Dl_info info;
+            if (dladdr(callSite, &info) != 0 && info.dli_sname != nullptr)
+            {
+                juce::String name(info.dli_sname);
+
+               #if JUCE_GCC || JUCE_CLANG
+                int status = 0;
+                if (auto* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status))
+                {
+                    name = demangled;
+                    std::free(demangled);
+                }
+               #endif
+
+                auto offset = (juce::pointer_sized_int) callSite - (juce::pointer_sized_int) info.dli_saddr;
+                return name + " + " + juce::String(offset) + " (" + address + ")";
+            }
+           #endif
+
+            return address;
+        }
+    }
+
+    //==============================================================================
+    void EventLog::record(EventType type, size_t size, const void* callSite) noexcept
+    {
+        switch (type)
+        {
+            case EventType::allocation:   ++numAllocations;   break;
+            case EventType::deallocation: ++numDeallocations; break;
+            case EventType::lock:         ++numLocks;         break;
+        }
+
+        if (nextSlot.load(std::memory_order_relaxed) >= capacity)
+            return;
+
+        auto index = nextSlot.fetch_add(1, std::memory_order_relaxed);
+        if (index >= capacity)
+            return;
+
+        auto& slot = slots[(size_t) index];
+        slot.event = { type, size, callSite };
+        slot.written.store(true, std::memory_order_release);
+    }
+
+    int EventLog::getEvents(Event* destination, int maxEvents) const noexcept
+    {
+        auto numSlots = juce::jmin(nextSlot.load(std::memory_order_relaxed), capacity, maxEvents);
+        int numCopied = 0;
+
+        for (int i = 0; i < numSlots; ++i)
+        {
+            auto& slot = slots[(size_t) i];
+            if (slot.written.load(std::memory_order_acquire))
+                destination[numCopied++] = slot.event;
+        }
+
+        return numCopied;
+    }
+
+    juce::String EventLog::createReport() const
+    {
+        std::vector<Event> events((size_t) capacity);
+        events.resize((size_t) getEvents(events.data(), capacity));
+
+        juce::String report;
+        report << "realtime scope: " << getNumAllocations() << " allocations, "
+               << getNumDeallocations() << " deallocations, "
+               << getNumLocks() << " locks" << juce::newLine;
+
+        //same type and call site reported once with a count, in the order they first happened
+        std::vector<std::pair<Event, int>> callSites;
+        for (const auto& event : events)
+        {
+            auto existing = std::find_if(callSites.begin(), callSites.end(), [&event](const auto& entry)
+            {
+                return entry.first.type == event.type && entry.first.callSite == event.callSite;
+            });
+
+            if (existing != callSites.end())
+                ++existing->second;
+            else
+                callSites.emplace_back(event, 1);
+        }
+
+        for (const auto& [event, count] : callSites)
+        {
+            report << "  " << count << "x " << getTypeName(event.type);
+            if (event.type == EventType::allocation)
+                report << " (" << (int) event.size << " bytes)";
+
+            report << " from " << describeCallSite(event.callSite) << juce::newLine;
+        }
+
+        if (getNumEvents() > (int) events.size())
+            report << "  (only the first " << capacity << " events keep a call site)" << juce::newLine;
+
+        return report;
+    }
+
+    void EventLog::reset() noexcept
+    {
+        for (auto& slot : slots)
+            slot.written.store(false, std::memory_order_relaxed);
+
+        numAllocations = 0;
+        numDeallocations = 0;
+        numLocks = 0;
+        nextSlot.store(0, std::memory_order_release);
+    }
+
+    EventLog& getEventLog() noexcept
+    {
+        return eventLog;
+    }
+
+    bool isInRealtimeScope() noexcept
+    {
+       #if SIMPLEEQ_RT_CHECKS
+        return realtimeDepth > 0;
+       #else
+        return false;
+       #endif
+    }
+
+   #if SIMPLEEQ_RT_CHECKS
+    ScopedRealtimeScope::ScopedRealtimeScope() noexcept  { ++realtimeDepth; }
+    ScopedRealtimeScope::~ScopedRealtimeScope() noexcept { --realtimeDepth; }
+   #endif
+}
+
+//==============================================================================
+#if SIMPLEEQ_RT_CHECKS
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #define SIMPLEEQ_HOOK_MALLOC 1
+#else
+ #define SIMPLEEQ_HOOK_MALLOC 0
+#endif
+
+#if defined (__GLIBC__)
+ #define SIMPLEEQ_LIBC_NOEXCEPT noexcept
+#else
+ #define SIMPLEEQ_LIBC_NOEXCEPT
+#endif
+
+namespace
+{
+    void record(RealtimeSafety::EventType type, std::size_t size, const void* callSite) noexcept
+    {
+        if (RealtimeSafety::isInRealtimeScope())
+            RealtimeSafety::getEventLog().record(type, size, callSite);
+    }
+}
+
+#if SIMPLEEQ_HOOK_MALLOC
+
+/*
+ the C allocator is replaced as well, HeapBlock and with it AudioBuffer, and anything else that calls malloc directly,
+ never pass through operator new. the real functions are looked up with dlsym(RTLD_NEXT) like pthread_mutex_lock below.
+ */
+namespace
+{
+    struct AllocatorFunctions
+    {
+        void* (*malloc)(std::size_t) = nullptr;
+        void* (*calloc)(std::size_t, std::size_t) = nullptr;
+        void* (*realloc)(void*, std::size_t) = nullptr;
+        void (*free)(void*) = nullptr;
+        int (*posixMemalign)(void**, std::size_t, std::size_t) = nullptr;
+        void* (*alignedAlloc)(std::size_t, std::size_t) = nullptr;
+    };
+
+    enum AllocatorState { unresolved, resolving, resolved };
+
+    AllocatorFunctions realAllocator;
+    std::atomic<int> allocatorState { unresolved };
+
+    /*
+     dlsym may allocate (glibc's dlerror buffer comes from calloc), while it runs allocations are served from here.
+     that only happens on the first allocation of the process, which comes before there are any other threads.
+     */
+    alignas(std::max_align_t) char bootstrapBuffer[8192];
+    std::atomic<std::size_t> bootstrapUsed { 0 };
+
+    bool isBootstrapMemory(const void* pointer) noexcept
+    {
+        auto* bytes = static_cast<const char*>(pointer);
+        return bytes >= bootstrapBuffer && bytes < bootstrapBuffer + sizeof(bootstrapBuffer);
+    }
+
+    void* allocateBootstrap(std::size_t size) noexcept
+    {
+        //never reused, so it's as zeroed as calloc promises
+        constexpr auto alignment = alignof(std::max_align_t);
+        size = (size + alignment - 1) & ~(alignment - 1);
+
+        auto offset = bootstrapUsed.fetch_add(size);
+        return offset + size <= sizeof(bootstrapBuffer) ? bootstrapBuffer + offset : nullptr;
+    }
+
+    template<typename Function>
+    Function resolveNext(const char* name) noexcept
+    {
+        return reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+    }
+
+    //nullptr while the lookup itself is running
+    const AllocatorFunctions* getRealAllocator() noexcept
+    {
+        if (allocatorState.load(std::memory_order_acquire) == resolved)
+            return &realAllocator;
+
+        int expected = unresolved;
+        if (! allocatorState.compare_exchange_strong(expected, resolving))
+            return expected == resolved ? &realAllocator : nullptr;
+
+        realAllocator.malloc        = resolveNext<decltype(realAllocator.malloc)>("malloc");
+        realAllocator.calloc        = resolveNext<decltype(realAllocator.calloc)>("calloc");
+        realAllocator.realloc       = resolveNext<decltype(realAllocator.realloc)>("realloc");
+        realAllocator.free          = resolveNext<decltype(realAllocator.free)>("free");
+        realAllocator.posixMemalign = resolveNext<decltype(realAllocator.posixMemalign)>("posix_memalign");
+        realAllocator.alignedAlloc  = resolveNext<decltype(realAllocator.alignedAlloc)>("aligned_alloc");
+
+        allocatorState.store(resolved, std::memory_order_release);
+        return &realAllocator;
+    }
+
+    void* allocateUnlogged(std::size_t size) noexcept
+    {
+        auto* real = getRealAllocator();
+        return real != nullptr ? real->malloc(size) : allocateBootstrap(size);
+    }
+
+    void* allocateAlignedUnlogged(std::size_t size, std::size_t alignment) noexcept
+    {
+        auto* real = getRealAllocator();
+        if (real == nullptr)
+            return alignment <= alignof(std::max_align_t) ? allocateBootstrap(size) : nullptr;
+
+        void* pointer = nullptr;
+        return real->posixMemalign(&pointer, alignment, size) == 0 ? pointer : nullptr;
+    }
+
+    void releaseUnlogged(void* pointer) noexcept
+    {
+        if (isBootstrapMemory(pointer))
+            return;
+
+        //only a free racing the very first lookup, the memory is leaked rather than handed to the wrong allocator
+        if (auto* real = getRealAllocator())
+            real->free(pointer);
+    }
+}
+
+extern "C" void* malloc(std::size_t size) SIMPLEEQ_LIBC_NOEXCEPT
+{
+    record(RealtimeSafety::EventType::allocation, size, SIMPLEEQ_RETURN_ADDRESS);
+    return allocateUnlogged(size);
+}
+
+extern "C" void* calloc(std::size_t count, std::size_t size) SIMPLEEQ_LIBC_NOEXCEPT
+{
+    record(RealtimeSafety::EventType::allocation, count * size, SIMPLEEQ_RETURN_ADDRESS);
+
+    if (auto* real = getRealAllocator())
+        return real->calloc(count, size);
+
+    return allocateBootstrap(count * size);
+}
+
+extern "C" void* realloc(void* pointer, std::size_t size) SIMPLEEQ_LIBC_NOEXCEPT
+{
+    record(RealtimeSafety::EventType::allocation, size, SIMPLEEQ_RETURN_ADDRESS);
+
+    auto* real = getRealAllocator();
+
+    if (real == nullptr || isBootstrapMemory(pointer))
+    {
+        //the old size isn't known, copy what can be there up to the end of the bootstrap buffer
+        auto* moved = real != nullptr ? real->malloc(size) : allocateBootstrap(size);
+        if (moved != nullptr && pointer != nullptr)
+            std::memcpy(moved, pointer, juce::jmin(size, (std::size_t) (bootstrapBuffer + sizeof(bootstrapBuffer) - static_cast<char*>(pointer))));
+
+        return moved;
+    }
+
+    return real->realloc(pointer, size);
+}
+
+extern "C" void free(void* pointer) SIMPLEEQ_LIBC_NOEXCEPT
+{
+    if (pointer == nullptr)
+        return;
+
+    record(RealtimeSafety::EventType::deallocation, 0, SIMPLEEQ_RETURN_ADDRESS);
+    releaseUnlogged(pointer);
+}
+
+extern "C" int posix_memalign(void** pointer, std::size_t alignment, std::size_t size) SIMPLEEQ_LIBC_NOEXCEPT
+{
+    record(RealtimeSafety::EventType::allocation, size, SIMPLEEQ_RETURN_ADDRESS);
+
+    if (auto* real = getRealAllocator())
+        return real->posixMemalign(pointer, alignment, size);
+
+    *pointer = allocateAlignedUnlogged(size, alignment);
+    return *pointer != nullptr ? 0 : ENOMEM;
+}
+
+extern "C" void* aligned_alloc(std::size_t alignment, std::size_t size) SIMPLEEQ_LIBC_NOEXCEPT
+{
+    record(RealtimeSafety::EventType::allocation, size, SIMPLEEQ_RETURN_ADDRESS);
+
+    if (auto* real = getRealAllocator(); real != nullptr && real->alignedAlloc != nullptr)
+        return real->alignedAlloc(alignment, size);
+
+    return allocateAlignedUnlogged(size, alignment);
+}
+
+#else
+
+//no portable way to interpose the C runtime's malloc here, only operator new is seen
+namespace
+{
+    void* allocateUnlogged(std::size_t size) noexcept { return std::malloc(size); }
+    void releaseUnlogged(void* pointer) noexcept      { std::free(pointer); }
+
+   #if JUCE_WINDOWS
+    void* allocateAlignedUnlogged(std::size_t size, std::size_t alignment) noexcept { return _aligned_malloc(size, alignment); }
+   #else
+    void* allocateAlignedUnlogged(std::size_t size, std::size_t alignment) noexcept
+    {
+        void* pointer = nullptr;
+        return posix_memalign(&pointer, alignment, size) == 0 ? pointer : nullptr;
+    }
+   #endif
+}
+
+#endif
+
+/*
+ replacements for the global allocation functions. with the default hidden visibility of a plugin build they
+ only see the plugin's own allocations, an executable (benchmarks, renderer) sees the whole process.
+ they take their memory from the real allocator directly, so an allocation is logged once, from the caller of new.
+ */
+namespace
+{
+    void* allocate(std::size_t size, const void* callSite) noexcept
+    {
+        record(RealtimeSafety::EventType::allocation, size, callSite);
+        return allocateUnlogged(size == 0 ? 1 : size);
+    }
+
+    void release(void* pointer, const void* callSite) noexcept
+    {
+        if (pointer == nullptr)
+            return;
+
+        record(RealtimeSafety::EventType::deallocation, 0, callSite);
+        releaseUnlogged(pointer);
+    }
+
+    //over-aligned types (SIMD registers and the groups holding them) come through the std::align_val_t overloads
+    void* allocateAligned(std::size_t size, std::align_val_t alignment, const void* callSite) noexcept
+    {
+        record(RealtimeSafety::EventType::allocation, size, callSite);
+
+        //posix_memalign wants at least pointer alignment
+        return allocateAlignedUnlogged(size == 0 ? 1 : size, juce::jmax(sizeof(void*), static_cast<std::size_t>(alignment)));
+    }
+
+    void releaseAligned(void* pointer, const void* callSite) noexcept
+    {
+        if (pointer == nullptr)
+            return;
+
+        record(RealtimeSafety::EventType::deallocation, 0, callSite);
+
+       #if JUCE_WINDOWS
+        _aligned_free(pointer);
+       #else
+        releaseUnlogged(pointer);
+       #endif
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    if (auto* pointer = allocate(size, SIMPLEEQ_RETURN_ADDRESS))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if (auto* pointer = allocate(size, SIMPLEEQ_RETURN_ADDRESS))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (auto* pointer = allocateAligned(size, alignment, SIMPLEEQ_RETURN_ADDRESS))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (auto* pointer = allocateAligned(size, alignment, SIMPLEEQ_RETURN_ADDRESS))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept   { return allocate(size, SIMPLEEQ_RETURN_ADDRESS); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size, SIMPLEEQ_RETURN_ADDRESS); }
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept   { return allocateAligned(size, alignment, SIMPLEEQ_RETURN_ADDRESS); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment, SIMPLEEQ_RETURN_ADDRESS); }
+
+void operator delete(void* pointer) noexcept                          { release(pointer, SIMPLEEQ_RETURN_ADDRESS); }
+void operator delete[](void* pointer) noexcept                        { release(pointer, SIMPLEEQ_RETURN_ADDRESS); }
+void operator delete(void* pointer, std::size_t) noexcept             { release(pointer, SIMPLEEQ_RETURN_ADDRESS); }
+void operator delete[](void* pointer, std::size_t) noexcept           { release(pointer, SIMPLEEQ_RETURN_ADDRESS); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept   { release(pointer, SIMPLEEQ_RETURN_ADDRESS); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { release(pointer, SIMPLEEQ_RETURN_ADDRESS); }
+
+void operator delete(void* pointer, std::align_val_t) noexcept                          { releaseAligned(pointer, SIMPLEEQ_RETURN_ADDRESS); }
+void operator delete[](void* pointer, std::align_val_t) noexcept                        { releaseAligned(pointer, SIMPLEEQ_RETURN_ADDRESS); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept             { releaseAligned(pointer, SIMPLEEQ_RETURN_ADDRESS); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept           { releaseAligned(pointer, SIMPLEEQ_RETURN_ADDRESS); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept   { releaseAligned(pointer, SIMPLEEQ_RETURN_ADDRESS); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(pointer, SIMPLEEQ_RETURN_ADDRESS); }
+
+/*
+ CriticalSection, std::mutex and friends all end up in pthread_mutex_lock on these platforms, CriticalSection::tryEnter
+ in pthread_mutex_trylock. there's no equivalent hook for EnterCriticalSection, so locks aren't logged on Windows.
+ */
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+
+namespace
+{
+    using MutexLockFunction = int (*)(pthread_mutex_t*);
+
+    //resolved on first use without a guarded static, the guard itself may take a pthread mutex
+    std::atomic<MutexLockFunction> realMutexLock { nullptr }, realMutexTryLock { nullptr };
+
+    MutexLockFunction getRealMutexFunction(std::atomic<MutexLockFunction>& function, const char* name) noexcept
+    {
+        auto resolvedFunction = function.load(std::memory_order_acquire);
+        if (resolvedFunction == nullptr)
+        {
+            resolvedFunction = reinterpret_cast<MutexLockFunction>(dlsym(RTLD_NEXT, name));
+            function.store(resolvedFunction, std::memory_order_release);
+        }
+
+        return resolvedFunction;
+    }
+}
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex) SIMPLEEQ_LIBC_NOEXCEPT
+{
+    record(RealtimeSafety::EventType::lock, 0, SIMPLEEQ_RETURN_ADDRESS);
+    return getRealMutexFunction(realMutexLock, "pthread_mutex_lock")(mutex);
+}
+
+extern "C" int pthread_mutex_trylock(pthread_mutex_t* mutex) SIMPLEEQ_LIBC_NOEXCEPT
+{
+    //a try that fails still touches the lock's cache line, and one that succeeds holds it
+    record(RealtimeSafety::EventType::lock, 0, SIMPLEEQ_RETURN_ADDRESS);
+    return getRealMutexFunction(realMutexTryLock, "pthread_mutex_trylock")(mutex);
+}
+
+#endif
+#endif
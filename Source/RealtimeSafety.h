@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.h
+    Profiling-build checks that catch allocations and lock acquisitions made
+    while the audio thread is inside processBlock.
+
+    Build with SIMPLEEQ_RT_CHECKS=1 (the "Profile" configuration in the .jucer)
+    to turn them on. Otherwise every class here compiles down to nothing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef SIMPLEEQ_RT_CHECKS
+ #define SIMPLEEQ_RT_CHECKS 0
+#endif
+
+namespace RealtimeSafety
+{
+    enum class EventType
+    {
+        allocation,
+        deallocation,
+        lock
+    };
+
+    struct Event
+    {
+        EventType type = EventType::allocation;
+        size_t size = 0;                    //bytes for allocations, 0 otherwise
+        const void* callSite = nullptr;     //return address of the intercepted call
+    };
+
+    /**
+     process-wide record of everything that happened inside a realtime scope.
+
+     written from the audio thread with atomics only (no allocation, no locks), so recording can't cause what it
+     is recording. keeps the first 'capacity' events since the last reset() in full and counts the rest.
+     */
+    class EventLog
+    {
+    public:
+        static constexpr int capacity = 512;
+
+        void record(EventType type, size_t size, const void* callSite) noexcept;
+
+        int getNumAllocations() const noexcept   { return numAllocations.load(); }
+        int getNumDeallocations() const noexcept { return numDeallocations.load(); }
+        int getNumLocks() const noexcept         { return numLocks.load(); }
+        int getNumEvents() const noexcept        { return getNumAllocations() + getNumDeallocations() + getNumLocks(); }
+
+        /** copies out the logged events that have been fully written, returns how many. */
+        int getEvents(Event* destination, int maxEvents) const noexcept;
+
+        /** counts per call site with symbol names where the platform can resolve them. allocates, call it off the audio thread. */
+        juce::String createReport() const;
+
+        /** must not run while any thread is inside a realtime scope. */
+        void reset() noexcept;
+
+    private:
+        struct Slot
+        {
+            Event event;
+            std::atomic<bool> written { false };
+        };
+
+        std::array<Slot, capacity> slots;
+        std::atomic<int> nextSlot { 0 };
+        std::atomic<int> numAllocations { 0 }, numDeallocations { 0 }, numLocks { 0 };
+    };
+
+    EventLog& getEventLog() noexcept;
+
+    /** true while the calling thread is inside a ScopedRealtimeScope. */
+    bool isInRealtimeScope() noexcept;
+
+    /**
+     marks the calling thread as realtime for its lifetime. scopes nest.
+     global operator new/delete, malloc and friends (Linux/macOS) and pthread mutex locks made by the plugin are logged
+     while one is alive.
+     */
+    class ScopedRealtimeScope
+    {
+    public:
+       #if SIMPLEEQ_RT_CHECKS
+        ScopedRealtimeScope() noexcept;
+        ~ScopedRealtimeScope() noexcept;
+       #else
+        ScopedRealtimeScope() noexcept {}
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedRealtimeScope)
+    };
+}
@@ -0,0 +1,364 @@
+/*
+  ==============================================================================
+
+    SVFCascade.h
+    The EQ cascade as topology-preserving transform state variable filters,
+    an alternative to the biquads whose frequencies can move every sample.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesign.h"
+
+/**
+ one TPT state variable section in Simper's form: trapezoidal integrators with g = tan(pi f / fs) and damping k,
+ the output mixes the input, band pass and low pass as m0 v0 + m1 v1 + m2 v2.
+
+ it's the bilinear transform of the same analog prototypes, prewarped the same way, as juce's makePeakFilter,
+ makeHighPass and makeLowPass, so the magnitude response matches the biquads. the difference is the state: two
+ integrator charges instead of past outputs, which stay valid when g changes. that's what lets the frequency be swept
+ every sample without the zipper and blow-ups a direct form biquad gets.
+ */
+template<typename NumericType>
+struct SVFCoefficients
+{
+    NumericType k {2}, m0 {1}, m1 {0}, m2 {0};
+    NumericType a1 {1}, a2 {0}, a3 {0};
+
+    //all a moving frequency costs per sample once g is known
+    void setG(NumericType g)
+    {
+        a1 = NumericType(1) / (NumericType(1) + g * (g + k));
+        a2 = g * a1;
+        a3 = g * a2;
+    }
+};
+
+namespace SVFDesign
+{
+    /**
+     g = tan(pi f / fs) through juce's Pade approximant: under 1e-7 relative error up to 0.49 fs (4.5e-9 at 20 kHz /
+     44.1 kHz), no call into the maths library. f is clamped below Nyquist, where tan would blow up.
+     */
+    template<typename NumericType>
+    NumericType prewarp(float frequency, NumericType piOverSampleRate)
+    {
+        const auto maxOmega = NumericType(0.49) * juce::MathConstants<NumericType>::pi;
+        const auto omega = juce::jlimit(NumericType(0), maxOmega, NumericType(frequency) * piOverSampleRate);
+        return juce::dsp::FastMathApproximations::tan(omega);
+    }
+
+    //same analog prototype as makePeakFilter: (s^2 + s A / Q + 1) / (s^2 + s / (A Q) + 1)
+    template<typename NumericType>
+    void makePeak(SVFCoefficients<NumericType>& out, double Q, double gainFactor)
+    {
+        const auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+        const auto k = 1.0 / (Q * A);
+
+        out.k = NumericType(k);
+        out.m0 = NumericType(1);
+        out.m1 = NumericType(k * (A * A - 1.0));
+        out.m2 = NumericType(0);
+    }
+
+    template<typename NumericType>
+    void makeHighPass(SVFCoefficients<NumericType>& out, double Q)
+    {
+        out.k = NumericType(1.0 / Q);
+        out.m0 = NumericType(1);
+        out.m1 = -out.k;
+        out.m2 = NumericType(-1);
+    }
+
+    template<typename NumericType>
+    void makeLowPass(SVFCoefficients<NumericType>& out, double Q)
+    {
+        out.k = NumericType(1.0 / Q);
+        out.m0 = NumericType(0);
+        out.m1 = NumericType(0);
+        out.m2 = NumericType(1);
+    }
+}
+
+/**
+ the whole EQ (low cut, peak, high cut) as SVF sections for every channel of the bus, a drop-in for ChainBankT.
+
+ each group (LowCut, Peak, HighCut in ChainPositions order) has one frequency shared by its sections. process() can
+ take a per sample frequency for any group, e.g. from an LFO, a sidechain or a parameter ramp: that group then costs one
+ prewarp() per sample plus one divide per section, shared by all channels. a group without one keeps the frequency it
+ was last set to (or last swept to) and costs nothing extra.
+
+ SampleType is float or double, channels run one after the other, section by section.
+ */
+template<typename SampleType>
+class SVFBank
+{
+public:
+    static constexpr int numGroups = 3;
+    static constexpr int maxSectionsPerGroup = maxCutSections;
+
+    /** allocates. */
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        piOverSampleRate = juce::MathConstants<SampleType>::pi / SampleType(spec.sampleRate);
+        numChannels = (int) spec.numChannels;
+        maxChunk = (int) spec.maximumBlockSize;
+
+        states.assign((size_t) numChannels, {});
+
+        for( auto& group : groups )
+        {
+            group.gSweep.assign((size_t) maxChunk, SampleType(0));
+            for( auto& sweep : group.sweeps )
+                sweep.assign((size_t) maxChunk, {});
+        }
+
+        updateAllG();
+    }
+
+    void reset()
+    {
+        for( auto& channel : states )
+            channel = {};
+    }
+
+    //whether two channels hold the same state in every active section
+    bool areChannelStatesEqual(int a, int b) const
+    {
+        const auto& first = states[(size_t) a];
+        const auto& second = states[(size_t) b];
+
+        for( int g = 0; g < numGroups; ++g )
+        {
+            for( int s = 0; s < groups[(size_t) g].numSections; ++s )
+            {
+                const auto i = (size_t) (g * maxSectionsPerGroup + s);
+                if( first[i].ic1 != second[i].ic1 || first[i].ic2 != second[i].ic2 )
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    void copyChannelState(int from, int to) { states[(size_t) to] = states[(size_t) from]; }
+
+    /**
+     samples until a group's ringing is below 'threshold', at the frequency it was last set or swept to. the sections
+     have the poles of the matching biquads, (1 + gk + g^2) z^2 + 2 (g^2 - 1) z + (1 - gk + g^2), so they decay the same.
+     */
+    double getDecayInSamples(int group, double threshold) const
+    {
+        const auto& g = groups[(size_t) group];
+        double total = 0.0;
+
+        for( int s = 0; s < g.numSections; ++s )
+        {
+            const auto& c = g.sections[(size_t) s];
+            const auto tanValue = double(c.a2) / double(c.a1);
+            const auto a1 = double(c.a1), k = double(c.k);
+
+            const BiquadCoefficients<double> poles { 1.0, 0.0, 0.0,
+                                                     2.0 * (tanValue * tanValue - 1.0) * a1,
+                                                     (1.0 - tanValue * k + tanValue * tanValue) * a1 };
+            total += CoefficientDesign::getDecayInSamples(poles, threshold);
+        }
+
+        return total;
+    }
+
+    void setLowCut(float frequency, int order)  { setCut(groups[lowCutGroup], frequency, order, true); }
+    void setHighCut(float frequency, int order) { setCut(groups[highCutGroup], frequency, order, false); }
+
+    void setPeak(float frequency, float Q, float gainFactor)
+    {
+        auto& group = groups[peakGroup];
+        group.numSections = 1;
+        group.frequency = frequency;
+        SVFDesign::makePeak(group.sections[0], Q, gainFactor);
+        updateG(group);
+    }
+
+    /**
+     filters the block. each non-null frequency array holds one frequency (Hz) per sample of the block for that group,
+     after the call the group stays at the last one. channels beyond the prepared count are left untouched.
+     */
+    void process(const juce::dsp::AudioBlock<SampleType>& block,
+                 const float* lowCutFrequencies = nullptr,
+                 const float* peakFrequencies = nullptr,
+                 const float* highCutFrequencies = nullptr) noexcept
+    {
+        const std::array<const float*, numGroups> frequencies { lowCutFrequencies, peakFrequencies, highCutFrequencies };
+        const auto channelsToProcess = juce::jmin((int) block.getNumChannels(), numChannels);
+        const auto numSamples = (int) block.getNumSamples();
+
+        //hosts occasionally send more than maximumBlockSize, the sweeps only hold that much
+        for( int start = 0; start < numSamples && maxChunk > 0; start += maxChunk )
+        {
+            const auto chunk = juce::jmin(maxChunk, numSamples - start);
+
+            std::array<bool, numGroups> sweeping;
+            for( int g = 0; g < numGroups; ++g )
+            {
+                sweeping[(size_t) g] = frequencies[(size_t) g] != nullptr && groups[(size_t) g].numSections > 0;
+                if( sweeping[(size_t) g] )
+                    prepareSweep(groups[(size_t) g], frequencies[(size_t) g] + start, chunk);
+            }
+
+            for( int ch = 0; ch < channelsToProcess; ++ch )
+            {
+                auto* data = block.getChannelPointer((size_t) ch) + start;
+                auto& channelStates = states[(size_t) ch];
+
+                for( int g = 0; g < numGroups; ++g )
+                {
+                    const auto& group = groups[(size_t) g];
+                    for( int s = 0; s < group.numSections; ++s )
+                    {
+                        auto& state = channelStates[(size_t) (g * maxSectionsPerGroup + s)];
+                        if( sweeping[(size_t) g] )
+                            processSweep(state, group.sections[(size_t) s], group.sweeps[(size_t) s].data(), data, chunk);
+                        else
+                            processFixed(state, group.sections[(size_t) s], data, chunk);
+                    }
+                }
+            }
+        }
+
+        for( auto& channel : states )
+        {
+            for( auto& state : channel )
+            {
+                juce::dsp::util::snapToZero(state.ic1);
+                juce::dsp::util::snapToZero(state.ic2);
+            }
+        }
+    }
+
+private:
+    struct State
+    {
+        SampleType ic1 {0}, ic2 {0};
+    };
+
+    //a1..a3 of one section at one sample of a sweep
+    struct SweepStep
+    {
+        SampleType a1, a2, a3;
+    };
+
+    struct Group
+    {
+        std::array<SVFCoefficients<SampleType>, maxSectionsPerGroup> sections;
+        std::vector<SampleType> gSweep;
+        std::array<std::vector<SweepStep>, maxSectionsPerGroup> sweeps;
+        int numSections = 0;
+        float frequency = 1000.f;
+    };
+
+    //same order as ChainPositions
+    static constexpr size_t lowCutGroup = 0, peakGroup = 1, highCutGroup = 2;
+
+    std::array<Group, numGroups> groups;
+    std::vector<std::array<State, numGroups * maxSectionsPerGroup>> states; //per channel, sections by group
+    SampleType piOverSampleRate {0};
+    int numChannels = 0, maxChunk = 0;
+
+    void setCut(Group& group, float frequency, int order, bool highPass)
+    {
+        jassert(order > 0 && order % 2 == 0 && order / 2 <= maxSectionsPerGroup);
+
+        //inactive sections keep their state, same as the biquad path
+        group.numSections = order / 2;
+        group.frequency = frequency;
+
+        for( int i = 0; i < group.numSections; ++i )
+        {
+            const auto Q = CoefficientDesign::butterworthQ(i, order);
+            if( highPass )
+                SVFDesign::makeHighPass(group.sections[(size_t) i], Q);
+            else
+                SVFDesign::makeLowPass(group.sections[(size_t) i], Q);
+        }
+
+        updateG(group);
+    }
+
+    void updateG(Group& group)
+    {
+        const auto g = SVFDesign::prewarp(group.frequency, piOverSampleRate);
+        for( int i = 0; i < group.numSections; ++i )
+            group.sections[(size_t) i].setG(g);
+    }
+
+    void updateAllG()
+    {
+        for( auto& group : groups )
+            updateG(group);
+    }
+
+    //one prewarp per sample for the whole group, then each section's a1..a3 along the sweep
+    void prepareSweep(Group& group, const float* frequencies, int numSamples) noexcept
+    {
+        auto* g = group.gSweep.data();
+        for( int i = 0; i < numSamples; ++i )
+            g[i] = SVFDesign::prewarp(frequencies[i], piOverSampleRate);
+
+        for( int s = 0; s < group.numSections; ++s )
+        {
+            const auto k = group.sections[(size_t) s].k;
+            auto* steps = group.sweeps[(size_t) s].data();
+
+            for( int i = 0; i < numSamples; ++i )
+            {
+                const auto a1 = SampleType(1) / (SampleType(1) + g[i] * (g[i] + k));
+                steps[i] = { a1, g[i] * a1, g[i] * g[i] * a1 };
+            }
+        }
+
+        group.frequency = frequencies[numSamples - 1];
+        updateG(group);
+    }
+
+    static void processFixed(State& state, const SVFCoefficients<SampleType>& c, SampleType* data, int numSamples) noexcept
+    {
+        auto ic1 = state.ic1, ic2 = state.ic2;
+
+        for( int i = 0; i < numSamples; ++i )
+        {
+            const auto v0 = data[i];
+            const auto v3 = v0 - ic2;
+            const auto v1 = c.a1 * ic1 + c.a2 * v3;
+            const auto v2 = ic2 + c.a2 * ic1 + c.a3 * v3;
+            ic1 = SampleType(2) * v1 - ic1;
+            ic2 = SampleType(2) * v2 - ic2;
+            data[i] = c.m0 * v0 + c.m1 * v1 + c.m2 * v2;
+        }
+
+        state.ic1 = ic1;
+        state.ic2 = ic2;
+    }
+
+    static void processSweep(State& state, const SVFCoefficients<SampleType>& c, const SweepStep* steps, SampleType* data, int numSamples) noexcept
+    {
+        auto ic1 = state.ic1, ic2 = state.ic2;
+
+        for( int i = 0; i < numSamples; ++i )
+        {
+            const auto& step = steps[i];
+            const auto v0 = data[i];
+            const auto v3 = v0 - ic2;
+            const auto v1 = step.a1 * ic1 + step.a2 * v3;
+            const auto v2 = ic2 + step.a2 * ic1 + step.a3 * v3;
+            ic1 = SampleType(2) * v1 - ic1;
+            ic2 = SampleType(2) * v2 - ic2;
+            data[i] = c.m0 * v0 + c.m1 * v1 + c.m2 * v2;
+        }
+
+        state.ic1 = ic1;
+        state.ic2 = ic2;
+    }
+};
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    SampleRing.h
+    Wait-free single producer / single consumer ring of raw samples that taps
+    the audio thread for the analyzer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ the audio thread copies each block in with one vector copy per channel (two when it wraps) and never waits:
+ it overwrites the oldest samples whether or not the reader has caught up.
+
+ the reader asks for the newest window it wants (by absolute sample position) and has it copied straight into
+ its own buffer, e.g. the FFT input. if the writer lapped the window while it was being read the read fails and
+ the reader just tries a newer one.
+ */
+class SampleRing
+{
+public:
+    /**
+     call while the audio thread isn't pushing (prepareToPlay). a reader on another thread is held off while the storage changes.
+     'historySize' is the longest window the reader will ask for, 'maxBlockSize' the largest chunk published at once.
+     */
+    void prepare(int numChannelsToHold, int historySize, int maxBlockSize)
+    {
+        jassert(numChannelsToHold > 0 && historySize > 0 && maxBlockSize > 0);
+
+        const juce::SpinLock::ScopedLockType sl(readerLock);
+
+        numChannels = numChannelsToHold;
+        blockSize = maxBlockSize;
+
+        //room for the window, the block being written and one block of slack for a reader that's mid-copy
+        capacity = juce::nextPowerOfTwo(historySize + 2 * maxBlockSize);
+        mask = capacity - 1;
+
+        samples.allocate((size_t) (numChannels * capacity), true);
+        writePosition.store(0, std::memory_order_release);
+    }
+
+    /**
+     audio thread. ring channel c takes buffer channel c, a buffer with fewer channels repeats its last one
+     (so a mono bus feeds both analyzer channels). double buffers are rounded to float on the way in.
+     */
+    template<typename SampleType>
+    void push(const juce::AudioBuffer<SampleType>& buffer) noexcept
+    {
+        const auto numSourceChannels = buffer.getNumChannels();
+        if( numSourceChannels == 0 || capacity == 0 )
+            return;
+
+        auto position = writePosition.load(std::memory_order_relaxed);
+
+        //anything larger than the prepared block size is published in pieces so the reader's slack still holds
+        for( int start = 0; start < buffer.getNumSamples(); start += blockSize )
+        {
+            const auto numSamples = juce::jmin(blockSize, buffer.getNumSamples() - start);
+            const auto index = (int) (position & mask);
+            const auto size1 = juce::jmin(numSamples, capacity - index);
+            const auto size2 = numSamples - size1;
+
+            for( int ch = 0; ch < numChannels; ++ch )
+            {
+                auto* source = buffer.getReadPointer(juce::jmin(ch, numSourceChannels - 1), start);
+                auto* destination = getChannel(ch);
+
+                copySamples(destination + index, source, size1);
+                if( size2 > 0 )
+                    copySamples(destination, source + size1, size2);
+            }
+
+            position += numSamples;
+            writePosition.store(position, std::memory_order_release);
+        }
+    }
+
+    /** total samples published so far, the newest readable window ends here. */
+    juce::int64 getWritePosition() const noexcept { return writePosition.load(std::memory_order_acquire); }
+
+    /**
+     copies the 'numSamples' samples of 'channel' that end at absolute position 'endPosition' into 'destination'.
+     returns false, leaving garbage in 'destination', if any of them isn't in the ring (not written yet, or already overwritten).
+     */
+    bool readWindow(int channel, juce::int64 endPosition, float* destination, int numSamples) const noexcept
+    {
+        const juce::SpinLock::ScopedLockType sl(readerLock);
+
+        if( ! juce::isPositiveAndBelow(channel, numChannels) )
+            return false;
+
+        const auto startPosition = endPosition - numSamples;
+        if( startPosition < 0 || endPosition > getWritePosition() || ! isReadable(startPosition) )
+            return false;
+
+        const auto index = (int) (startPosition & mask);
+        const auto size1 = juce::jmin(numSamples, capacity - index);
+        const auto* source = getChannel(channel);
+
+        juce::FloatVectorOperations::copy(destination, source + index, size1);
+        if( size1 < numSamples )
+            juce::FloatVectorOperations::copy(destination + size1, source, numSamples - size1);
+
+        //seqlock style: if the writer got too close while we were copying, the copy may be torn
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return isReadable(startPosition);
+    }
+
+    int getNumChannels() const noexcept { return numChannels; }
+    int getCapacity() const noexcept { return capacity; }
+    int getMaxBlockSize() const noexcept { return blockSize; }
+
+private:
+    juce::HeapBlock<float> samples;
+    int numChannels = 0, capacity = 0, mask = 0, blockSize = 0;
+    std::atomic<juce::int64> writePosition { 0 };
+    mutable juce::SpinLock readerLock; //between prepare() and readWindow() only, the writer never takes it
+
+    static void copySamples(float* destination, const float* source, int numSamples) noexcept
+    {
+        juce::FloatVectorOperations::copy(destination, source, numSamples);
+    }
+
+    static void copySamples(float* destination, const double* source, int numSamples) noexcept
+    {
+        for( int i = 0; i < numSamples; ++i )
+            destination[i] = (float) source[i];
+    }
+
+    float* getChannel(int channel) noexcept { return samples.get() + (size_t) (channel * capacity); }
+    const float* getChannel(int channel) const noexcept { return samples.get() + (size_t) (channel * capacity); }
+
+    //the writer may already be filling the block after the published position, which must not reach startPosition
+    bool isReadable(juce::int64 startPosition) const noexcept
+    {
+        return getWritePosition() + blockSize - startPosition <= capacity;
+    }
+};